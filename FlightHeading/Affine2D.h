@@ -0,0 +1,62 @@
+#pragma once
+#include "Core.h"
+#include <cmath>
+
+// 2D affine transform, the top two rows of a 3x3 matrix. Stored column major so it uploads as a GLSL
+// mat3x2 as is. Gauges and traffic symbols only ever rotate, scale and translate in the screen plane,
+// and composing or applying one of these is 6 multiplies where a glm::mat4 takes 64 or 16.
+struct Affine2D
+{
+	float M00 = 1.f, M10 = 0.f; // First column
+	float M01 = 0.f, M11 = 1.f; // Second column
+	float Tx = 0.f, Ty = 0.f;   // Translation
+
+	// Counterclockwise rotation by Radians, then uniform Scale, then translation by (X, Y), so T * S * R.
+	// In glm that is glm::rotate(glm::scale(glm::translate(I, t), s), a) about z.
+	static inline Affine2D RotationScaleTranslation(float Radians, float Scale = 1.f, float X = 0.f, float Y = 0.f)
+	{
+		const float C = std::cos(Radians) * Scale;
+		const float S = std::sin(Radians) * Scale;
+		Affine2D Out;
+		Out.M00 = C;
+		Out.M10 = S;
+		Out.M01 = -S;
+		Out.M11 = C;
+		Out.Tx = X;
+		Out.Ty = Y;
+		return Out;
+	}
+
+	// This applied after Other
+	inline Affine2D operator*(const Affine2D& Other) const
+	{
+		Affine2D Out;
+		Out.M00 = M00 * Other.M00 + M01 * Other.M10;
+		Out.M10 = M10 * Other.M00 + M11 * Other.M10;
+		Out.M01 = M00 * Other.M01 + M01 * Other.M11;
+		Out.M11 = M10 * Other.M01 + M11 * Other.M11;
+		Out.Tx = M00 * Other.Tx + M01 * Other.Ty + Tx;
+		Out.Ty = M10 * Other.Tx + M11 * Other.Ty + Ty;
+		return Out;
+	}
+
+	inline void Apply(float X, float Y, float& OutX, float& OutY) const
+	{
+		OutX = M00 * X + M01 * Y + Tx;
+		OutY = M10 * X + M11 * Y + Ty;
+	}
+
+	// One transform over many points, structure of arrays so the loop vectorizes
+	inline void Apply(const float* __restrict X, const float* __restrict Y, float* __restrict OutX, float* __restrict OutY, uint Count) const
+	{
+		const float A = M00, B = M01, C = M10, D = M11, E = Tx, F = Ty;
+		for (uint i = 0; i < Count; i++)
+		{
+			OutX[i] = A * X[i] + B * Y[i] + E;
+			OutY[i] = C * X[i] + D * Y[i] + F;
+		}
+	}
+
+	inline const float* Data() const { return &M00; }
+};
+static_assert(sizeof(Affine2D) == 6 * sizeof(float), "Affine2D uploads as a tightly packed mat3x2");
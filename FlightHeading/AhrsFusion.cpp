@@ -0,0 +1,262 @@
+#include "AhrsFusion.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr float DegreesToRadians = 3.14159265f / 180.f;
+	constexpr float RadiansToDegrees = 180.f / 3.14159265f;
+
+	// The epsilon keeps a zero vector (or a converged gradient) from producing NaNs without a branch
+	inline float InvSqrt(float Value)
+	{
+		return 1.f / std::sqrt(Value + 1e-20f);
+	}
+
+	// One Madgwick MARG step (gradient descent on gravity and the horizontal/vertical field) for
+	// Count independent streams. Q is the body to earth rotation, earth frame x north, y west, z up.
+	// The single stream filter runs it with Count 1; for the batch the lanes share nothing, so with
+	// the pointers marked unaliased the loop body vectorizes.
+	void MadgwickStep(float* __restrict Q0s, float* __restrict Q1s, float* __restrict Q2s, float* __restrict Q3s,
+		const float* __restrict Gxs, const float* __restrict Gys, const float* __restrict Gzs,
+		const float* __restrict Axs, const float* __restrict Ays, const float* __restrict Azs,
+		const float* __restrict Mxs, const float* __restrict Mys, const float* __restrict Mzs, uint Count, float Beta, float Dt)
+	{
+		for (uint i = 0; i < Count; i++)
+		{
+			float Q0 = Q0s[i], Q1 = Q1s[i], Q2 = Q2s[i], Q3 = Q3s[i];
+			const float Gx = Gxs[i], Gy = Gys[i], Gz = Gzs[i];
+			float Ax = Axs[i], Ay = Ays[i], Az = Azs[i];
+			float Mx = Mxs[i], My = Mys[i], Mz = Mzs[i];
+
+			float Norm = InvSqrt(Ax * Ax + Ay * Ay + Az * Az);
+			Ax *= Norm; Ay *= Norm; Az *= Norm;
+			Norm = InvSqrt(Mx * Mx + My * My + Mz * Mz);
+			Mx *= Norm; My *= Norm; Mz *= Norm;
+
+			const float Q0Q0 = Q0 * Q0, Q0Q1 = Q0 * Q1, Q0Q2 = Q0 * Q2, Q0Q3 = Q0 * Q3;
+			const float Q1Q1 = Q1 * Q1, Q1Q2 = Q1 * Q2, Q1Q3 = Q1 * Q3;
+			const float Q2Q2 = Q2 * Q2, Q2Q3 = Q2 * Q3, Q3Q3 = Q3 * Q3;
+
+			// Measured field rotated into the earth frame, then flattened onto the x-z plane
+			const float Hx = Mx * (Q0Q0 + Q1Q1 - Q2Q2 - Q3Q3) + 2.f * My * (Q1Q2 - Q0Q3) + 2.f * Mz * (Q1Q3 + Q0Q2);
+			const float Hy = 2.f * Mx * (Q1Q2 + Q0Q3) + My * (Q0Q0 - Q1Q1 + Q2Q2 - Q3Q3) + 2.f * Mz * (Q2Q3 - Q0Q1);
+			const float Bx = std::sqrt(Hx * Hx + Hy * Hy);
+			const float Bz = 2.f * Mx * (Q1Q3 - Q0Q2) + 2.f * My * (Q2Q3 + Q0Q1) + Mz * (Q0Q0 - Q1Q1 - Q2Q2 + Q3Q3);
+
+			// Objective: predicted minus measured gravity and field, in the sensor frame
+			const float F0 = 2.f * (Q1Q3 - Q0Q2) - Ax;
+			const float F1 = 2.f * (Q0Q1 + Q2Q3) - Ay;
+			const float F2 = 2.f * (0.5f - Q1Q1 - Q2Q2) - Az;
+			const float F3 = 2.f * Bx * (0.5f - Q2Q2 - Q3Q3) + 2.f * Bz * (Q1Q3 - Q0Q2) - Mx;
+			const float F4 = 2.f * Bx * (Q1Q2 - Q0Q3) + 2.f * Bz * (Q0Q1 + Q2Q3) - My;
+			const float F5 = 2.f * Bx * (Q0Q2 + Q1Q3) + 2.f * Bz * (0.5f - Q1Q1 - Q2Q2) - Mz;
+
+			// Jacobian transpose times objective
+			float S0 = -2.f * Q2 * F0 + 2.f * Q1 * F1 - 2.f * Bz * Q2 * F3 + (-2.f * Bx * Q3 + 2.f * Bz * Q1) * F4 + 2.f * Bx * Q2 * F5;
+			float S1 = 2.f * Q3 * F0 + 2.f * Q0 * F1 - 4.f * Q1 * F2 + 2.f * Bz * Q3 * F3 + (2.f * Bx * Q2 + 2.f * Bz * Q0) * F4 + (2.f * Bx * Q3 - 4.f * Bz * Q1) * F5;
+			float S2 = -2.f * Q0 * F0 + 2.f * Q3 * F1 - 4.f * Q2 * F2 + (-4.f * Bx * Q2 - 2.f * Bz * Q0) * F3 + (2.f * Bx * Q1 + 2.f * Bz * Q3) * F4 + (2.f * Bx * Q0 - 4.f * Bz * Q2) * F5;
+			float S3 = 2.f * Q1 * F0 + 2.f * Q2 * F1 + (-4.f * Bx * Q3 + 2.f * Bz * Q1) * F3 + (-2.f * Bx * Q0 + 2.f * Bz * Q2) * F4 + 2.f * Bx * Q1 * F5;
+			Norm = Beta * InvSqrt(S0 * S0 + S1 * S1 + S2 * S2 + S3 * S3);
+			S0 *= Norm; S1 *= Norm; S2 *= Norm; S3 *= Norm;
+
+			// Gyro rate of change minus the correction, integrated over Dt
+			const float Dot0 = 0.5f * (-Q1 * Gx - Q2 * Gy - Q3 * Gz) - S0;
+			const float Dot1 = 0.5f * (Q0 * Gx + Q2 * Gz - Q3 * Gy) - S1;
+			const float Dot2 = 0.5f * (Q0 * Gy - Q1 * Gz + Q3 * Gx) - S2;
+			const float Dot3 = 0.5f * (Q0 * Gz + Q1 * Gy - Q2 * Gx) - S3;
+			Q0 += Dot0 * Dt;
+			Q1 += Dot1 * Dt;
+			Q2 += Dot2 * Dt;
+			Q3 += Dot3 * Dt;
+
+			Norm = InvSqrt(Q0 * Q0 + Q1 * Q1 + Q2 * Q2 + Q3 * Q3);
+			Q0 *= Norm; Q1 *= Norm; Q2 *= Norm; Q3 *= Norm;
+
+			Q0s[i] = Q0; Q1s[i] = Q1; Q2s[i] = Q2; Q3s[i] = Q3;
+		}
+	}
+
+	inline float HeadingFromQuaternion(float Q0, float Q1, float Q2, float Q3)
+	{
+		// Yaw is counter-clockwise about up, heading is clockwise from north
+		return HeadingMath::Wrap360(-std::atan2(Q1 * Q2 + Q0 * Q3, 0.5f - Q2 * Q2 - Q3 * Q3) * RadiansToDegrees);
+	}
+
+	// North, west and up in the sensor frame, from gravity and the magnetic field
+	void EarthAxes(const float Accel[3], const float Mag[3], float North[3], float West[3], float Up[3])
+	{
+		float Norm = InvSqrt(Accel[0] * Accel[0] + Accel[1] * Accel[1] + Accel[2] * Accel[2]);
+		Up[0] = Accel[0] * Norm; Up[1] = Accel[1] * Norm; Up[2] = Accel[2] * Norm;
+
+		West[0] = Up[1] * Mag[2] - Up[2] * Mag[1];
+		West[1] = Up[2] * Mag[0] - Up[0] * Mag[2];
+		West[2] = Up[0] * Mag[1] - Up[1] * Mag[0];
+		Norm = InvSqrt(West[0] * West[0] + West[1] * West[1] + West[2] * West[2]);
+		West[0] *= Norm; West[1] *= Norm; West[2] *= Norm;
+
+		North[0] = West[1] * Up[2] - West[2] * Up[1];
+		North[1] = West[2] * Up[0] - West[0] * Up[2];
+		North[2] = West[0] * Up[1] - West[1] * Up[0];
+	}
+
+	// Body to earth rotation whose rows are the earth axes seen from the sensor
+	void AlignQuaternion(const float Accel[3], const float Mag[3], float& Q0, float& Q1, float& Q2, float& Q3)
+	{
+		float N[3], W[3], U[3];
+		EarthAxes(Accel, Mag, N, W, U);
+
+		const float Trace = N[0] + W[1] + U[2];
+		if (Trace > 0.f)
+		{
+			const float S = 0.5f / std::sqrt(Trace + 1.f);
+			Q0 = 0.25f / S; Q1 = (U[1] - W[2]) * S; Q2 = (N[2] - U[0]) * S; Q3 = (W[0] - N[1]) * S;
+		}
+		else if (N[0] > W[1] && N[0] > U[2])
+		{
+			const float S = 2.f * std::sqrt(1.f + N[0] - W[1] - U[2]);
+			Q0 = (U[1] - W[2]) / S; Q1 = 0.25f * S; Q2 = (N[1] + W[0]) / S; Q3 = (N[2] + U[0]) / S;
+		}
+		else if (W[1] > U[2])
+		{
+			const float S = 2.f * std::sqrt(1.f + W[1] - N[0] - U[2]);
+			Q0 = (N[2] - U[0]) / S; Q1 = (N[1] + W[0]) / S; Q2 = 0.25f * S; Q3 = (W[2] + U[1]) / S;
+		}
+		else
+		{
+			const float S = 2.f * std::sqrt(1.f + U[2] - N[0] - W[1]);
+			Q0 = (W[0] - N[1]) / S; Q1 = (N[2] + U[0]) / S; Q2 = (W[2] + U[1]) / S; Q3 = 0.25f * S;
+		}
+	}
+}
+
+// Begin- AhrsFusion
+float AhrsFusion::TiltCompensatedHeading(const float Accel[3], const float Mag[3])
+{
+	float North[3], West[3], Up[3];
+	EarthAxes(Accel, Mag, North, West, Up);
+	// The forward axis projected onto north and east
+	return HeadingMath::Wrap360(std::atan2(-West[0], North[0]) * RadiansToDegrees);
+}
+
+ImuSample AhrsFusion::SimulateSample(float HeadingDegrees, float PitchDegrees, float RollDegrees, float YawRateDegrees, float DipDegrees)
+{
+	// Body to earth rotation Rz(yaw) * Ry(-pitch) * Rx(roll); yaw is counter-clockwise, pitch nose up
+	const float Yaw = -HeadingDegrees * DegreesToRadians;
+	const float Pitch = -PitchDegrees * DegreesToRadians;
+	const float Roll = RollDegrees * DegreesToRadians;
+	const float Cy = std::cos(Yaw), Sy = std::sin(Yaw);
+	const float Cp = std::cos(Pitch), Sp = std::sin(Pitch);
+	const float Cr = std::cos(Roll), Sr = std::sin(Roll);
+	const float R[3][3] =
+	{
+		{ Cy * Cp, Cy * Sp * Sr - Sy * Cr, Cy * Sp * Cr + Sy * Sr },
+		{ Sy * Cp, Sy * Sp * Sr + Cy * Cr, Sy * Sp * Cr - Cy * Sr },
+		{ -Sp, Cp * Sr, Cp * Cr }
+	};
+
+	// Earth vectors seen from the sensor are R transposed times the vector
+	auto ToBody = [&R](const float (&Earth)[3], float (&Body)[3])
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			Body[i] = R[0][i] * Earth[0] + R[1][i] * Earth[1] + R[2][i] * Earth[2];
+		}
+	};
+
+	const float Dip = DipDegrees * DegreesToRadians;
+	const float Up[3] = { 0.f, 0.f, 1.f };
+	const float Field[3] = { std::cos(Dip), 0.f, -std::sin(Dip) };
+	const float Rotation[3] = { 0.f, 0.f, -YawRateDegrees * DegreesToRadians };
+
+	ImuSample Sample;
+	ToBody(Up, Sample.Accel);
+	ToBody(Field, Sample.Mag);
+	ToBody(Rotation, Sample.Gyro);
+	return Sample;
+}
+// End- AhrsFusion
+
+// Begin- AhrsFilter
+AhrsFilter::AhrsFilter(float InBeta)
+	: Beta(InBeta)
+{
+}
+
+void AhrsFilter::Reset(const ImuSample& Sample)
+{
+	AlignQuaternion(Sample.Accel, Sample.Mag, Q[0], Q[1], Q[2], Q[3]);
+	Aligned = true;
+}
+
+void AhrsFilter::Update(const ImuSample& Sample, float Dt)
+{
+	if (!Aligned)
+	{
+		Reset(Sample);
+		return;
+	}
+
+	MadgwickStep(&Q[0], &Q[1], &Q[2], &Q[3], &Sample.Gyro[0], &Sample.Gyro[1], &Sample.Gyro[2],
+		&Sample.Accel[0], &Sample.Accel[1], &Sample.Accel[2], &Sample.Mag[0], &Sample.Mag[1], &Sample.Mag[2], 1, Beta, Dt);
+}
+
+float AhrsFilter::GetHeadingDegrees() const
+{
+	return HeadingFromQuaternion(Q[0], Q[1], Q[2], Q[3]);
+}
+
+void AhrsFilter::GetRollPitchDegrees(float& OutRoll, float& OutPitch) const
+{
+	OutRoll = std::atan2(Q[2] * Q[3] + Q[0] * Q[1], 0.5f - Q[1] * Q[1] - Q[2] * Q[2]) * RadiansToDegrees;
+	OutPitch = std::asin(std::min(std::max(2.f * (Q[1] * Q[3] - Q[0] * Q[2]), -1.f), 1.f)) * RadiansToDegrees;
+}
+// End- AhrsFilter
+
+// Begin- AhrsBatch
+void AhrsBatch::Samples::Resize(uint Count)
+{
+	for (std::vector<float>* Lane : { &GyroX, &GyroY, &GyroZ, &AccelX, &AccelY, &AccelZ, &MagX, &MagY, &MagZ })
+	{
+		Lane->resize(Count);
+	}
+}
+
+void AhrsBatch::Samples::Set(uint Rig, const ImuSample& Sample)
+{
+	GyroX[Rig] = Sample.Gyro[0]; GyroY[Rig] = Sample.Gyro[1]; GyroZ[Rig] = Sample.Gyro[2];
+	AccelX[Rig] = Sample.Accel[0]; AccelY[Rig] = Sample.Accel[1]; AccelZ[Rig] = Sample.Accel[2];
+	MagX[Rig] = Sample.Mag[0]; MagY[Rig] = Sample.Mag[1]; MagZ[Rig] = Sample.Mag[2];
+}
+
+AhrsBatch::AhrsBatch(uint InRigCount, float InBeta)
+	: Beta(InBeta), RigCount(InRigCount), Q0(InRigCount, 1.f), Q1(InRigCount, 0.f), Q2(InRigCount, 0.f), Q3(InRigCount, 0.f)
+{
+}
+
+void AhrsBatch::Reset(const Samples& In)
+{
+	for (uint Rig = 0; Rig < RigCount; Rig++)
+	{
+		const float Accel[3] = { In.AccelX[Rig], In.AccelY[Rig], In.AccelZ[Rig] };
+		const float Mag[3] = { In.MagX[Rig], In.MagY[Rig], In.MagZ[Rig] };
+		AlignQuaternion(Accel, Mag, Q0[Rig], Q1[Rig], Q2[Rig], Q3[Rig]);
+	}
+}
+
+void AhrsBatch::Update(const Samples& In, float Dt)
+{
+	ASSERT(In.GyroX.size() >= RigCount);
+	MadgwickStep(Q0.data(), Q1.data(), Q2.data(), Q3.data(), In.GyroX.data(), In.GyroY.data(), In.GyroZ.data(),
+		In.AccelX.data(), In.AccelY.data(), In.AccelZ.data(), In.MagX.data(), In.MagY.data(), In.MagZ.data(), RigCount, Beta, Dt);
+}
+
+void AhrsBatch::GetHeadingsDegrees(float* OutHeadings) const
+{
+	for (uint Rig = 0; Rig < RigCount; Rig++)
+	{
+		OutHeadings[Rig] = HeadingFromQuaternion(Q0[Rig], Q1[Rig], Q2[Rig], Q3[Rig]);
+	}
+}
+// End- AhrsBatch
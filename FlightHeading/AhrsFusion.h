@@ -0,0 +1,76 @@
+#pragma once
+#include "Core.h"
+#include <vector>
+
+// Raw IMU sample in the sensor frame: x forward, y left, z up (a level sensor at rest reads +1 g
+// on z). Gyro in rad/s; accelerometer and magnetometer in any unit, only their directions matter.
+struct ImuSample
+{
+	float Gyro[3] = {};
+	float Accel[3] = {};
+	float Mag[3] = {};
+};
+
+// Madgwick MARG orientation filter. The gradient-descent step pulls the integrated gyro attitude
+// towards gravity and the magnetic field, with Beta trading gyro drift against sensor noise.
+namespace AhrsFusion
+{
+	// Magnetic heading of a sensor from one accelerometer/magnetometer pair, compensated for tilt
+	float TiltCompensatedHeading(const float Accel[3], const float Mag[3]);
+
+	// What a sensor at the given attitude, turning about the vertical at YawRate, would measure.
+	// DipDegrees is the inclination of the magnetic field. Used by rigs, tools and benchmarks.
+	ImuSample SimulateSample(float HeadingDegrees, float PitchDegrees, float RollDegrees, float YawRateDegrees, float DipDegrees = 60.f);
+}
+
+// One stream
+class AhrsFilter
+{
+public:
+	explicit AhrsFilter(float InBeta = 0.05f);
+
+	// Aligns the attitude with the accelerometer and magnetometer instead of converging from level north
+	void Reset(const ImuSample& Sample);
+	void Update(const ImuSample& Sample, float Dt);
+
+	// Magnetic heading in [0, 360)
+	float GetHeadingDegrees() const;
+	void GetRollPitchDegrees(float& OutRoll, float& OutPitch) const;
+
+	float Beta;
+
+private:
+	float Q[4] = { 1.f, 0.f, 0.f, 0.f };
+	bool Aligned = false;
+};
+
+// Many streams stored as structure of arrays, one lane per rig. Every rig takes one sample per
+// Update, so the loop over rigs has no dependencies between lanes and vectorizes.
+class AhrsBatch
+{
+public:
+	struct Samples
+	{
+		std::vector<float> GyroX, GyroY, GyroZ;
+		std::vector<float> AccelX, AccelY, AccelZ;
+		std::vector<float> MagX, MagY, MagZ;
+
+		void Resize(uint Count);
+		void Set(uint Rig, const ImuSample& Sample);
+	};
+
+	explicit AhrsBatch(uint InRigCount, float InBeta = 0.05f);
+
+	void Reset(const Samples& In);
+	void Update(const Samples& In, float Dt);
+
+	// Writes one magnetic heading per rig
+	void GetHeadingsDegrees(float* OutHeadings) const;
+	inline uint GetRigCount() const { return RigCount; }
+
+	float Beta;
+
+private:
+	uint RigCount;
+	std::vector<float> Q0, Q1, Q2, Q3;
+};
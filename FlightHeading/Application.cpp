@@ -1,44 +1,242 @@
 #include "Application.h"
+#include "FontAtlasBake.h"
+#include "HeadingMath.h"
+#include "ResourceMemory.h"
+#include "Trace.h"
+#include "UIRenderer.h"
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 
-Application::Application()
+Application::Application(bool InHeadless)
+    : Headless(InHeadless)
 {
+    TRACE_THREAD("Main");
     CreateWindow();
-    InitUI();
+    if (!Headless)
+    {
+        InitUI();
+    }
+    if (FramebufferSamples > 1)
+    {
+        Transparency = TransparencyMode::AlphaToCoverage;
+    }
+    ResourceMemory::SetBudget(size_t(MemoryBudgetMB * 1024.f * 1024.f));
     LoadRenderData();
+
+    if (!Headless)
+    {
+        LoadMagneticModel();
+        ResourceWatcher.Start("res");
+        FeedThreadRunning = true;
+        FeedThread = std::thread(&Application::FeedLoop, this);
+    }
 }
 
 Application::~Application()
 {
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    StopRenderThread();
+    ResourceWatcher.Stop();
+    FeedThreadRunning = false;
+    if (FeedThread.joinable())
+    {
+        FeedThread.join();
+    }
 
+    if (!Headless)
+    {
+        for (UIDrawDataCopy& Copy : UICopies)
+        {
+            for (ImDrawList* List : Copy.Lists)
+            {
+                IM_DELETE(List);
+            }
+        }
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    // GL objects have to go while the context still exists
+    Resources.Clear();
+    QuadVAO.reset();
+    GaugeInstances.reset();
+    DrawUniforms.reset();
+    GaugeTarget.reset();
+    FrameTimer.reset();
+    RetainedUI.reset();
     glfwTerminate();
 }
 
 void Application::Run()
 {
     ASSERT(Window);
-    SetViewport();
-    DrawRectShader->Bind();
-    RectVAO->Bind();
+    CardDamper.Reset(GetTargetHeading());
+    LastFrameTime = glfwGetTime();
+    LastActivityTime = LastFrameTime;
+    glfwSwapInterval(VSync ? 1 : 0);
+    Pacer.Reset();
 
     while (!glfwWindowShouldClose(Window))
     {
-        ClearWindow();
-        BeginUIFrame();
-        Draw();
-        RenderUI(Window);
-        EndUIFrame();
+        TRACE_SCOPE("Frame");
+        if (UseRenderThread != RenderThreadRunning)
+        {
+            UseRenderThread ? StartRenderThread() : StopRenderThread();
+        }
 
-        glfwSwapBuffers(Window);
+        const double FrameTime = glfwGetTime();
+        Update(float(FrameTime - LastFrameTime));
+        LastFrameTime = FrameTime;
+        UpdateResolutionScale();
+
+        // The gauges are recorded before the UI runs, so a setting changed in the UI applies from the next frame
+        const FrameState State = CaptureFrameState();
+        SubmitRender([this, State]()
+        {
+            ReloadChangedResources();
+            FrameTimer->Begin();
+            ClearWindow();
+            DrawGauges(State);
+        });
+        SubmitUI(FrameTime);
+        EndFrame();
+
+        {
+            TRACE_SCOPE("PollEvents");
+            glfwPollEvents();
+        }
+        PaceFrame();
+    }
+    StopRenderThread();
+}
+
+void Application::SubmitRender(std::function<void()> Command)
+{
+    if (RenderThreadRunning)
+    {
+        Recording.push_back(std::move(Command));
+    }
+    else
+    {
+        Command();
+    }
+}
+
+// Hands the recorded frame to the render thread, waiting while it is RenderQueueDepth frames behind
+void Application::EndFrame()
+{
+    if (RenderThreadRunning)
+    {
+        TRACE_SCOPE("WaitForRenderThread");
+        RenderQueue.Push(std::move(Recording));
+        Recording.clear();
+    }
+}
+
+// The context can only be current on one thread, so the main thread lets go of it first
+void Application::StartRenderThread()
+{
+    if (RenderThreadRunning)
+    {
+        return;
+    }
+    glfwMakeContextCurrent(nullptr);
+    RenderQueue.Reopen();
+    RenderThread = std::thread(&Application::RenderLoop, this);
+    RenderThreadRunning = true;
+}
+
+// Runs whatever was recorded, then takes the context back
+void Application::StopRenderThread()
+{
+    if (!RenderThreadRunning)
+    {
+        return;
+    }
+    if (!Recording.empty())
+    {
+        RenderQueue.Push(std::move(Recording));
+        Recording.clear();
+    }
+    RenderQueue.Close();
+    RenderThread.join();
+    RenderThreadRunning = false;
+    glfwMakeContextCurrent(Window);
+}
+
+void Application::RenderLoop()
+{
+    TRACE_THREAD("Render");
+    glfwMakeContextCurrent(Window);
+
+    RenderCommandList Commands;
+    while (RenderQueue.Pop(Commands))
+    {
+        TRACE_SCOPE("RenderFrame");
+        for (const std::function<void()>& Command : Commands)
+        {
+            Command();
+        }
+        Commands.clear();
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+// Input, or a card that is moving or about to
+bool Application::HasActivity() const
+{
+    const float Target = GetTargetHeading();
+    return InputPending
+        || std::fabs(HeadingMath::ShortestArc(PacedHeading, Target)) > StableDegrees
+        || std::fabs(HeadingMath::ShortestArc(CardDamper.GetHeading(), Target)) > StableDegrees;
+}
+
+// Waits for the start of the next frame. While idle, events and the feed are checked every few
+// milliseconds so the first input or heading change brings the full rate straight back.
+void Application::PaceFrame()
+{
+    const double Now = glfwGetTime();
+    if (HasActivity())
+    {
+        LastActivityTime = Now;
+    }
+    Pacer.SetIdle(LowPower && Now - LastActivityTime > IdleAfterSeconds);
+    PacedHeading = GetTargetHeading();
+    InputPending = false;
+
+    Pacer.Wait([this]()
+    {
         glfwPollEvents();
+        UpdateFeed();
+        return HasActivity() || glfwWindowShouldClose(Window);
+    });
+}
+
+// Between frames: queues reloads for whatever changed under res/ and swaps in the ones that are ready
+void Application::ReloadChangedResources()
+{
+    for (const std::string& Path : ResourceWatcher.TakeChanges())
+    {
+        Resources.Reload(Path);
     }
+
+    Resources.ApplyReloads();
+}
+
+void Application::RenderFrame(float Heading, uint Width, uint Height)
+{
+    // Every batch frame is a still, so no smoothing between them
+    CurrentHeading = Heading;
+    CardDamper.Reset(GetTargetHeading());
+    GLCALL(glViewport(0, 0, Width, Height));
+    ClearWindow();
+    Draw(CaptureFrameState(), Width, Height);
 }
 
 void Application::CreateWindow()
@@ -47,6 +245,9 @@ void Application::CreateWindow()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, Headless ? GLFW_FALSE : GLFW_TRUE);
+    // Offscreen rendering brings its own framebuffer
+    glfwWindowHint(GLFW_SAMPLES, Headless ? 0 : MsaaSamples);
 
     Window = glfwCreateWindow(WindowWidth, WindowHeight, "Heading", NULL, NULL);
 
@@ -69,12 +270,28 @@ void Application::CreateWindow()
         }
     });
 
+    // Any input wakes frame pacing from idle. Installed before ImGui's, which chains to them.
+    static const auto MarkInput = [](GLFWwindow* InWindow)
+    {
+        Application* App = static_cast<Application*>(glfwGetWindowUserPointer(InWindow));
+        if (App)
+        {
+            App->InputPending = true;
+            App->UIRebuildFrames = UIFramesAfterInput;
+        }
+    };
+    glfwSetCursorPosCallback(Window, [](GLFWwindow* InWindow, double, double) { MarkInput(InWindow); });
+    glfwSetMouseButtonCallback(Window, [](GLFWwindow* InWindow, int, int, int) { MarkInput(InWindow); });
+    glfwSetScrollCallback(Window, [](GLFWwindow* InWindow, double, double) { MarkInput(InWindow); });
+    glfwSetKeyCallback(Window, [](GLFWwindow* InWindow, int, int, int, int) { MarkInput(InWindow); });
+
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
         ASSERTNOENTRY("Something is not right!");
         return;
     }
+    GLCALL(glGetIntegerv(GL_SAMPLES, &FramebufferSamples));
 }
 
 void Application::InitUI()
@@ -87,19 +304,159 @@ void Application::InitUI()
     ImGui::StyleColorsDark();
     ImGui_ImplGlfw_InitForOpenGL(Window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+    LoadFonts();
+    // Uploads the font atlas now, NewFrame needs it and may run on a thread without the context
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+}
+
+namespace
+{
+    const std::string FontConfigPath = "res/fonts/Fonts.cfg";
+    const std::string FontAtlasPath = "res/fonts/UI.fhfa";
+}
+
+bool Application::BakeFonts()
+{
+    FontBakeConfig Config;
+    if (!Config.Load(FontConfigPath))
+    {
+        std::cout << "Could not read " << FontConfigPath << std::endl;
+        return false;
+    }
+    return FontAtlasBake::Build(Config, FontAtlasPath);
+}
+
+// The baked atlas when it matches the config, otherwise it is baked again for the next start. Without
+// a config ImGui's default font is rasterized as before.
+void Application::LoadFonts()
+{
+    TRACE_SCOPE("LoadFonts");
+    ImFontAtlas& Atlas = *ImGui::GetIO().Fonts;
+    FontBakeConfig Config;
+    if (!Config.Load(FontConfigPath))
+    {
+        return;
+    }
+    if (FontAtlasBake::Load(FontAtlasPath, Config, Atlas))
+    {
+        return;
+    }
+    if (FontAtlasBake::Build(Config, FontAtlasPath) && FontAtlasBake::Load(FontAtlasPath, Config, Atlas))
+    {
+        return;
+    }
+
+    // Atlas.Build keeps pointers to the ranges, so it runs while Config is alive
+    Atlas.Clear();
+    Config.AddTo(Atlas);
+    Atlas.Build();
 }
 
+// Only UI logic, the renderer backend's part runs in DrawUI
 void Application::BeginUIFrame()
 {
-    ImGui_ImplOpenGL3_NewFrame();
+    TRACE_SCOPE("BeginUIFrame");
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 }
 
 void Application::EndUIFrame()
 {
+    TRACE_SCOPE("EndUIFrame");
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
+// Rebuilds the UI when it is due and records its draw, followed by the end of the frame. Only draw
+// data that changed is handed over, copied when another thread renders it.
+void Application::SubmitUI(double FrameTime)
+{
+    UIStatsCounting.Frames++;
+    if (FrameTime - UIStatsStart >= 1.0)
+    {
+        UIStatsLast = UIStatsCounting;
+        UIStatsCounting = UICacheStats();
+        UIStatsStart = FrameTime;
+    }
+
+    ImDrawData* DrawData = nullptr;
+    uint64_t DataHash = 0;
+    const bool Rebuild = !RetainUI || UIRebuildFrames > 0 || FrameTime - LastUIBuildTime >= 1.0 / std::max(UIRefreshHz, 1.f);
+    if (Rebuild)
+    {
+        BeginUIFrame();
+        RenderUI(Window);
+        EndUIFrame();
+        UIRebuildFrames = UIRebuildFrames > 0 ? UIRebuildFrames - 1 : 0;
+        LastUIBuildTime = FrameTime;
+        UIStatsCounting.Rebuilds++;
+
+        DataHash = RetainUI ? UIRenderer::Hash(*ImGui::GetDrawData()) : 0;
+        if (DataHash == 0 || DataHash != SubmittedUIHash)
+        {
+            DrawData = RenderThreadRunning ? CopyDrawData(ImGui::GetDrawData()) : ImGui::GetDrawData();
+            SubmittedUIHash = DataHash;
+            UIStatsCounting.Uploads++;
+        }
+    }
+
+    SubmitRender([this, DrawData, DataHash]()
+    {
+        DrawUI(DrawData, DataHash);
+        FrameTimer->End();
+        CollectGpuTimes();
+        ResourceMemory::EndFrame();
+        TRACE_SCOPE("SwapBuffers");
+        glfwSwapBuffers(Window);
+    });
+}
+
+// Copies into the oldest slot of UICopies. The bounded queue keeps the render thread at most
+// RenderQueueDepth frames behind, so that slot's frame has been submitted already. Lists are only
+// allocated and freed here on the main thread, as ImGui's allocator is not thread safe.
+ImDrawData* Application::CopyDrawData(const ImDrawData* Source)
+{
+    TRACE_SCOPE("CopyDrawData");
+    UIDrawDataCopy& Copy = UICopies[NextUICopy];
+    NextUICopy = (NextUICopy + 1) % (RenderQueueDepth + 2);
+
+    if (!Copy.Data)
+    {
+        Copy.Data = std::make_shared<ImDrawData>();
+    }
+    while (Copy.Lists.size() < size_t(Source->CmdListsCount))
+    {
+        Copy.Lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+    }
+
+    ImDrawData& Data = *Copy.Data;
+    Data = *Source;
+    for (int i = 0; i < Source->CmdListsCount; i++)
+    {
+        const ImDrawList* From = Source->CmdLists[i];
+        ImDrawList* To = Copy.Lists[i];
+        To->CmdBuffer = From->CmdBuffer;
+        To->IdxBuffer = From->IdxBuffer;
+        To->VtxBuffer = From->VtxBuffer;
+        To->Flags = From->Flags;
+        Data.CmdLists[i] = To;
+    }
+    return &Data;
+}
+
+// New draw data is uploaded, without it the cached buffers are drawn again. ImGui's own backend
+// only looks after the font texture.
+void Application::DrawUI(ImDrawData* DrawData, uint64_t DataHash)
+{
+    ImGui_ImplOpenGL3_NewFrame(); // Recreates the backend's GL objects if they are missing
+    Shader* Program = Resources.Get(UIProgram);
+    if (DrawData)
+    {
+        RetainedUI->Render(*DrawData, DataHash, *Program);
+    }
+    else
+    {
+        RetainedUI->RenderCached(*Program);
+    }
 }
 
 void Application::FrameBufferSizeCallback(GLFWwindow* Window, int Width, int Height)
@@ -107,17 +464,73 @@ void Application::FrameBufferSizeCallback(GLFWwindow* Window, int Width, int Hei
     ViewportWidth = std::min(Width, Height);
     WindowWidth = Width;
     WindowHeight = Height;
-
-    SetViewport();
+    InputPending = true;
+    UIRebuildFrames = UIFramesAfterInput;
 }
 
 void Application::RenderUI(GLFWwindow* Window)
 {
+    TRACE_SCOPE("RenderUI");
     ImGui::Begin("Control Panel");
 
     ImGui::Text("Heading (degree):");
     ImGui::SliderFloat("##Heading", &CurrentHeading, MinHeading, MaxHeading, "%.1f");
+    ImGui::SliderFloat("Card damping (s)", &CardDamper.SmoothTime, 0.f, 1.f, "%.2f");
+    int Mode = int(Transparency);
+    if (ImGui::Combo("Transparency", &Mode, "Alpha test\0Premultiplied blend\0Alpha to coverage\0"))
+    {
+        SetTransparency(TransparencyMode(Mode));
+    }
+    if (Transparency == TransparencyMode::AlphaToCoverage && FramebufferSamples <= 1)
+    {
+        ImGui::TextDisabled("No MSAA on this window, edges are a single sample");
+    }
     ImGui::Spacing();
+
+    if (ImGui::CollapsingHeader("Heading Reference"))
+    {
+        RenderHeadingReferenceUI();
+    }
+
+    if (ImGui::CollapsingHeader("Simulator Feed"))
+    {
+        RenderFeedUI();
+    }
+
+    if (ImGui::CollapsingHeader("History"))
+    {
+        RenderHistoryUI();
+    }
+
+    if (ImGui::CollapsingHeader("Trace"))
+    {
+        RenderTraceUI();
+    }
+
+    if (ImGui::CollapsingHeader("Memory"))
+    {
+        RenderMemoryUI();
+    }
+
+    if (ImGui::CollapsingHeader("Resolution"))
+    {
+        RenderResolutionUI();
+    }
+
+    if (ImGui::CollapsingHeader("Frame Pacing"))
+    {
+        RenderPacingUI();
+    }
+
+    if (ImGui::CollapsingHeader("Threading"))
+    {
+        RenderThreadingUI();
+    }
+
+    if (ImGui::CollapsingHeader("UI Cache"))
+    {
+        RenderUICacheUI();
+    }
     
     static const ImVec2 ExitButtonSize = ImVec2(100, 30);
     if (ImGui::Button("Exit", ExitButtonSize))
@@ -126,6 +539,339 @@ void Application::RenderUI(GLFWwindow* Window)
     }
 
     ImGui::End();
+
+    // Reference label in the top left corner of the gauge
+    const ImVec2 LabelPosition = ImVec2(8.f, float(WindowHeight - ViewportWidth) + 8.f);
+    ImGui::GetForegroundDrawList()->AddText(LabelPosition, IM_COL32(255, 255, 255, 255), ShowTrueHeading ? "TRU" : "MAG");
+}
+
+// Runs on its own thread: polls every feed slot and keeps the arbiter up to date, more slowly while idle
+void Application::FeedLoop()
+{
+    TRACE_THREAD("Feed");
+    HeadingFeedReader Reader;
+    HeadingFeedSample Sample;
+
+    while (FeedThreadRunning)
+    {
+        if (!Reader.IsOpen() && !Reader.Open())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        FeedConnected = true;
+
+        {
+            TRACE_SCOPE("Arbitrate");
+            for (uint Source = 0; Source < Arbiter.GetSourceCount(); Source++)
+            {
+                if (Reader.Read(Source, Sample))
+                {
+                    Arbiter.Submit(Source, Sample.TimeUs, Sample.HeadingDegrees);
+                }
+            }
+            Arbiter.Update(HeadingFeed::NowUs());
+        }
+
+        // Every publisher has exited and the feed is gone, so wait for a new one
+        if (!Reader.HasWriters())
+        {
+            Reader.Close();
+            FeedConnected = false;
+            continue;
+        }
+
+        // Idle frames only need to see a new heading soon enough to end idle, not within a millisecond
+        std::this_thread::sleep_for(std::chrono::milliseconds(Pacer.IsIdle() ? FeedIdlePollMs : 1));
+    }
+}
+
+void Application::UpdateFeed()
+{
+    FeedHeading = Arbiter.Load(HeadingFeed::NowUs());
+    if (FollowFeed && FeedHeading.IsUsable())
+    {
+        CurrentHeading = FeedHeading.HeadingDegrees;
+    }
+}
+
+void Application::RenderFeedUI()
+{
+    if (!FeedConnected)
+    {
+        ImGui::TextDisabled("Waiting for a publisher on %s", HeadingFeed::DefaultName);
+        return;
+    }
+
+    ImGui::Checkbox("Follow feed", &FollowFeed);
+
+    const uchar Flags = FeedHeading.Flags;
+    if (FeedHeading.IsUsable())
+    {
+        ImGui::Text("Arbitrated: %.1f deg%s", FeedHeading.HeadingDegrees, (Flags & ArbitrationDegraded) ? " (degraded)" : "");
+    }
+    else
+    {
+        ImGui::TextColored(ImVec4(1.f, 0.6f, 0.f, 1.f), (Flags & ArbitrationStale) ? "Arbitrated: stale" : "Arbitrated: no valid source");
+    }
+    if (Flags & ArbitrationMiscompare)
+    {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.f, 0.25f, 0.25f, 1.f), "HDG MISCOMPARE");
+    }
+
+    static const char* SourceNames[] = { "AHRS 1", "AHRS 2", "Standby", "Source 4" };
+    const int64_t NowUs = HeadingFeed::NowUs();
+    for (uint Source = 0; Source < Arbiter.GetSourceCount(); Source++)
+    {
+        const ArbitratedHeading State = Arbiter.LoadSource(Source, NowUs);
+        if (!(State.Flags & ArbitrationValid))
+        {
+            ImGui::TextDisabled("%-8s no fresh data", SourceNames[Source]);
+            continue;
+        }
+
+        const uint32_t AgeMs = uint32_t(NowUs / 1000) - State.TimeMs;
+        const ImVec4 Color = (State.Flags & ArbitrationMiscompare) ? ImVec4(1.f, 0.25f, 0.25f, 1.f) : ImGui::GetStyleColorVec4(ImGuiCol_Text);
+        ImGui::TextColored(Color, "%-8s %6.1f deg  %4u ms", SourceNames[Source], State.HeadingDegrees, AgeMs);
+    }
+}
+
+// The coefficient file changes every five years, the cached grid is rebuilt whenever it is for another
+// model or more than a quarter of a year away from today (secular variation is a few arcminutes a year)
+void Application::LoadMagneticModel()
+{
+    TRACE_SCOPE("LoadMagneticModel");
+    static const std::string ModelPath = "res/wmm/WMM.COF";
+    static const std::string GridPath = "res/wmm/declination.fhdg";
+    static const float GridStepDegrees = 1.f;
+
+    const double Today = MagneticModel::DecimalYearNow();
+    MagneticModel Model;
+    const bool HasModel = Model.Load(ModelPath);
+
+    if (Declination.Open(GridPath))
+    {
+        const bool SameModel = !HasModel || Declination.GetModelEpoch() == Model.GetEpoch();
+        if (SameModel && (!HasModel || std::fabs(Declination.GetDecimalYear() - Today) <= 0.25))
+        {
+            return;
+        }
+        Declination.Close();
+    }
+
+    if (!HasModel)
+    {
+        std::cout << "No magnetic model at " << ModelPath << ", true heading is not available" << std::endl;
+        return;
+    }
+
+    if (DeclinationGrid::Build(Model, Today, GridStepDegrees, GridPath))
+    {
+        Declination.Open(GridPath);
+    }
+}
+
+void Application::RenderHeadingReferenceUI()
+{
+    if (!Declination.IsOpen())
+    {
+        ImGui::TextDisabled("No magnetic model loaded");
+        ShowTrueHeading = false;
+        return;
+    }
+
+    int Reference = ShowTrueHeading ? 1 : 0;
+    ImGui::RadioButton("Magnetic", &Reference, 0);
+    ImGui::SameLine();
+    ImGui::RadioButton("True", &Reference, 1);
+    ShowTrueHeading = Reference == 1;
+
+    ImGui::InputFloat("Latitude", &Latitude, 0.1f, 1.f, "%.3f");
+    ImGui::InputFloat("Longitude", &Longitude, 0.1f, 1.f, "%.3f");
+    Latitude = std::min(std::max(Latitude, -90.f), 90.f);
+    Longitude = std::min(std::max(Longitude, -180.f), 180.f);
+
+    ImGui::Text("Variation: %.1f deg %s (%.1f)", std::fabs(Variation), Variation >= 0.f ? "E" : "W", Declination.GetDecimalYear());
+    ImGui::Text("Magnetic %.1f / True %.1f", CurrentHeading, HeadingMath::Wrap360(CurrentHeading + Variation));
+}
+
+float Application::GetTargetHeading() const
+{
+    return ShowTrueHeading ? HeadingMath::Wrap360(CurrentHeading + Variation) : CurrentHeading;
+}
+
+// Everything that advances with time, once per frame before anything is drawn
+void Application::Update(float DeltaSeconds)
+{
+    TRACE_SCOPE("Update");
+    UpdateFeed();
+    Variation = Declination.Lookup(Latitude, Longitude);
+    History.Push(glfwGetTime(), CurrentHeading);
+    CardDamper.Update(GetTargetHeading(), DeltaSeconds);
+}
+
+void Application::RenderTraceUI()
+{
+    static const char* TracePath = "trace.json";
+    if (!Trace::IsRecording())
+    {
+        if (ImGui::Button("Start recording"))
+        {
+            Trace::Start();
+        }
+    }
+    else if (ImGui::Button("Stop and save"))
+    {
+        Trace::Stop(TracePath);
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s, open in chrome://tracing", TracePath);
+}
+
+void Application::RenderMemoryUI()
+{
+    constexpr float MB = 1024.f * 1024.f;
+    const ResourceMemory::Totals Totals = ResourceMemory::GetTotals();
+    ImGui::Text("Textures: %.2f MB (with mips)", Totals.TextureBytes / MB);
+    ImGui::Text("Buffers: %.2f MB", Totals.BufferBytes / MB);
+    ImGui::Text("CPU copies: %.2f MB", Totals.CpuBytes / MB);
+    ImGui::Text("Resident: %u, evicted: %u, evictions: %u", Totals.Resident, Totals.Evicted, Totals.Evictions);
+
+    if (ImGui::SliderFloat("GPU budget (MB)", &MemoryBudgetMB, 0.f, 512.f, MemoryBudgetMB > 0.f ? "%.0f" : "Unlimited"))
+    {
+        ResourceMemory::SetBudget(size_t(MemoryBudgetMB * MB));
+    }
+
+    if (ImGui::BeginTable("Resources", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+    {
+        const uint64_t Frame = ResourceMemory::GetFrame();
+        ImGui::TableSetupColumn("Resource");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableSetupColumn("Last used");
+        ImGui::TableHeadersRow();
+        for (const ResourceMemory::Entry& Entry : ResourceMemory::GetEntries())
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(Entry.Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text(Entry.Resident ? "%.3f" : "%.3f (evicted)", Entry.GpuBytes / MB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu frames ago", (unsigned long long)(Frame - Entry.LastUsedFrame));
+        }
+        ImGui::EndTable();
+    }
+}
+
+void Application::RenderResolutionUI()
+{
+    if (ImGui::Checkbox("Dynamic resolution", &DynamicResolution))
+    {
+        Scaler.Reset();
+    }
+    ImGui::SliderFloat("GPU target (ms)", &Scaler.TargetMs, 2.f, 33.f, "%.1f");
+    ImGui::SliderFloat("Minimum scale", &Scaler.MinScale, 0.25f, 1.f, "%.2f");
+
+    const uint RenderSize = DynamicResolution ? std::max(uint(ViewportWidth * Scaler.GetScale() + 0.5f), 1u) : ViewportWidth;
+    ImGui::Text("GPU frame: %.2f ms", GpuFrameMs.load());
+    ImGui::Text("Gauges: %u x %u (%.0f%%) on %u x %u", RenderSize, RenderSize, 100.f * RenderSize / std::max(ViewportWidth, 1u), ViewportWidth, ViewportWidth);
+}
+
+void Application::RenderPacingUI()
+{
+    if (ImGui::Checkbox("VSync", &VSync))
+    {
+        const int Interval = VSync ? 1 : 0;
+        SubmitRender([Interval]() { glfwSwapInterval(Interval); });
+    }
+    if (ImGui::SliderFloat("Target rate (Hz)", &Pacer.TargetHz, 0.f, 240.f, Pacer.TargetHz > 0.f ? "%.0f" : "Unlimited"))
+    {
+        Pacer.Reset();
+    }
+    ImGui::Checkbox("Low power when still", &LowPower);
+    ImGui::SliderFloat("Idle rate (Hz)", &Pacer.IdleHz, 1.f, 30.f, "%.0f");
+    ImGui::SliderFloat("Idle after (s)", &IdleAfterSeconds, 0.5f, 10.f, "%.1f");
+
+    const PacingStats Stats = Pacer.GetStats();
+    ImGui::Text("%s, %.1f Hz achieved", Pacer.IsIdle() ? "Idle" : "Active", Stats.MeanIntervalMs > 0.f ? 1000.f / Stats.MeanIntervalMs : 0.f);
+    ImGui::Text("Interval %.2f ms (target %.2f), jitter %.3f ms", Stats.MeanIntervalMs, Stats.TargetIntervalMs, Stats.JitterMs);
+    ImGui::Text("Late by %.3f ms mean, %.3f ms max, %u missed", Stats.MeanLatenessMs, Stats.MaxLatenessMs, Stats.Missed);
+}
+
+void Application::RenderThreadingUI()
+{
+    ImGui::Checkbox("Render thread", &UseRenderThread);
+    ImGui::TextDisabled(RenderThreadRunning ? "Events and UI here, GL and swaps on the render thread" : "Everything on the main thread");
+}
+
+void Application::RenderUICacheUI()
+{
+    ImGui::Checkbox("Retained UI", &RetainUI);
+    ImGui::SliderFloat("Refresh when idle (Hz)", &UIRefreshHz, 1.f, 60.f, "%.0f");
+    const float Frames = float(std::max(UIStatsLast.Frames, 1u));
+    ImGui::Text("Rebuilt %.0f%%, uploaded %.0f%% of %u frames/s", 100.f * UIStatsLast.Rebuilds / Frames, 100.f * UIStatsLast.Uploads / Frames, UIStatsLast.Frames);
+}
+
+// Min/max envelope plus the mean of every bucket, one column per bucket
+static void PlotEnvelope(const char* Label, const std::vector<SeriesBucket>& Buckets, double Start, double End, float MinValue, float MaxValue, bool WrapHeading)
+{
+    const ImVec2 Origin = ImGui::GetCursorScreenPos();
+    const ImVec2 Size = ImVec2(std::max(ImGui::GetContentRegionAvail().x, 240.f), 80.f);
+    ImGui::InvisibleButton(Label, Size);
+
+    ImDrawList* DrawList = ImGui::GetWindowDrawList();
+    DrawList->AddRectFilled(Origin, ImVec2(Origin.x + Size.x, Origin.y + Size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+    DrawList->PushClipRect(Origin, ImVec2(Origin.x + Size.x, Origin.y + Size.y), true);
+
+    const ImU32 EnvelopeColor = ImGui::GetColorU32(ImGuiCol_PlotLines, 0.4f);
+    const ImU32 MeanColor = ImGui::GetColorU32(ImGuiCol_PlotLines);
+    auto ToX = [&](double Time) { return Origin.x + float((Time - Start) / (End - Start)) * Size.x; };
+    auto ToY = [&](float Value) { return Origin.y + (1.f - (Value - MinValue) / (MaxValue - MinValue)) * Size.y; };
+
+    ImVec2 Previous;
+    bool HasPrevious = false;
+    for (const SeriesBucket& Bucket : Buckets)
+    {
+        const float Offset = WrapHeading ? HeadingMath::Wrap360(Bucket.Mean) - Bucket.Mean : 0.f;
+        const float X = ToX(Bucket.Time);
+        DrawList->AddLine(ImVec2(X, ToY(Bucket.Min + Offset)), ImVec2(X, ToY(Bucket.Max + Offset) - 1.f), EnvelopeColor);
+
+        const ImVec2 Point = ImVec2(X, ToY(Bucket.Mean + Offset));
+        const bool Wrapped = WrapHeading && std::fabs(Point.y - Previous.y) > Size.y * 0.5f;
+        if (HasPrevious && !Wrapped)
+        {
+            DrawList->AddLine(Previous, Point, MeanColor);
+        }
+        Previous = Point;
+        HasPrevious = true;
+    }
+
+    DrawList->PopClipRect();
+    DrawList->AddText(ImVec2(Origin.x + 4.f, Origin.y + 2.f), ImGui::GetColorU32(ImGuiCol_Text), Label);
+}
+
+void Application::RenderHistoryUI()
+{
+    ImGui::Text("Window (seconds):");
+    ImGui::SliderFloat("##HistoryWindow", &HistoryWindowSeconds, 10.f, 8.f * 3600.f, "%.0f", ImGuiSliderFlags_Logarithmic);
+
+    // One bucket per horizontal pixel at most, whatever the window length
+    const uint MaxPoints = uint(std::max(ImGui::GetContentRegionAvail().x, 240.f));
+    const double End = History.GetLatestTime();
+    const double Start = End - HistoryWindowSeconds;
+
+    History.GetHeading().Query(Start, End, MaxPoints, PlotBuckets);
+    PlotEnvelope("Heading", PlotBuckets, Start, End, 0.f, 360.f, true);
+
+    History.GetRateOfTurn().Query(Start, End, MaxPoints, PlotBuckets);
+    float RateLimit = 3.f; // Standard rate turn, deg/s
+    for (const SeriesBucket& Bucket : PlotBuckets)
+    {
+        RateLimit = std::max(RateLimit, std::max(std::fabs(Bucket.Min), std::fabs(Bucket.Max)));
+    }
+    PlotEnvelope("Rate of turn", PlotBuckets, Start, End, -RateLimit, RateLimit, false);
+    ImGui::Text("Rate of turn range: +/-%.1f deg/s", RateLimit);
 }
 
 void Application::ClearWindow()
@@ -134,58 +880,300 @@ void Application::ClearWindow()
     GLCALL(glClear(GL_COLOR_BUFFER_BIT));
 }
 
-void Application::Draw()
+namespace
+{
+    // Instances in the gauge texture buffer, one per textured layer
+    enum GaugeLayer
+    {
+        CompassCard,
+        CompassBezel,
+        GaugeLayerCount
+    };
+
+    constexpr uint GaugeInstanceTexels = 2;
+    constexpr uint InstanceTextureSlot = 1;
+    constexpr uint FrameBlockBinding = 0;
+    constexpr uint GaugeBlockBinding = 1;
+
+    struct GaugeLayerDesc
+    {
+        const char* TexturePath;
+        std::vector<std::string> Defines; // Program permutation, see DrawQuad.vert and DrawRect.frag
+        glm::vec4 UvRect;                 // Region of the texture drawn with ATLAS, offset in xy, size in zw
+        bool FollowsHeading;
+    };
+
+    const GaugeLayerDesc GaugeLayerDescs[GaugeLayerCount] =
+    {
+        { "res/textures/CompassBackground.png", {}, glm::vec4(0.f, 0.f, 1.f, 1.f), true },
+        { "res/textures/CompassForeground.png", {}, glm::vec4(0.f, 0.f, 1.f, 1.f), false },
+    };
+
+    // Member offsets of the uniform blocks in GaugeBlocks.glsl
+    struct FrameBlockLayout
+    {
+        uint ViewportSize, TimeSeconds, HeadingDegrees, Size;
+    };
+
+    struct GaugeBlockLayout
+    {
+        uint Tint, UvRect, FirstInstance, HeadingFollow, Size;
+    };
+
+    FrameBlockLayout MakeFrameBlockLayout()
+    {
+        Std140Layout Layout;
+        FrameBlockLayout Block;
+        Block.ViewportSize = Layout.PushVec2();
+        Block.TimeSeconds = Layout.PushFloat();
+        Block.HeadingDegrees = Layout.PushFloat();
+        Block.Size = Layout.GetSize();
+        return Block;
+    }
+
+    GaugeBlockLayout MakeGaugeBlockLayout()
+    {
+        Std140Layout Layout;
+        GaugeBlockLayout Block;
+        Block.Tint = Layout.PushVec4();
+        Block.UvRect = Layout.PushVec4();
+        Block.FirstInstance = Layout.PushInt();
+        Block.HeadingFollow = Layout.PushFloat();
+        Block.Size = Layout.GetSize();
+        return Block;
+    }
+
+    const FrameBlockLayout FrameBlock = MakeFrameBlockLayout();
+    const GaugeBlockLayout GaugeBlock = MakeGaugeBlockLayout();
+}
+
+// The gauges straight into the viewport, or with dynamic resolution into the scaled corner of
+// GaugeTarget and then stretched over the viewport
+void Application::DrawGauges(const FrameState& State)
 {
-    constexpr static const char* rectTexture = "rectTexture";
-    constexpr static const char* modelMat = "modelMat";
-    constexpr static const glm::mat4 IdentityMat = glm::mat4(1.0f);
+    const uint RenderSize = State.RenderSize;
+    if (!State.DynamicResolution)
+    {
+        GLCALL(glViewport(0, 0, State.ViewportWidth, State.ViewportWidth));
+        Draw(State, RenderSize, RenderSize);
+        return;
+    }
 
-    const float HeadingRadians = glm::radians(CurrentHeading);
-    const glm::mat4 HeadingMat = glm::rotate(IdentityMat, HeadingRadians, glm::vec3(0.0f, 0.0f, 1.0f));
+    GaugeTarget->Resize(State.ViewportWidth, State.ViewportWidth);
+    GaugeTarget->Bind(RenderSize, RenderSize);
+    ClearWindow();
+    Draw(State, RenderSize, RenderSize);
+    GaugeTarget->Resolve(RenderSize, RenderSize);
 
-    CompassBackground->Bind(0);
-    DrawRectShader->SetUniform1i(rectTexture, 0);
-    DrawRectShader->SetUniformMatrix4f(modelMat, HeadingMat);
-    GLCALL(glDrawElements(GL_TRIANGLES, RectIB->GetCount(), GL_UNSIGNED_INT, 0));
+    TRACE_SCOPE("Upsample");
+    GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GLCALL(glViewport(0, 0, State.ViewportWidth, State.ViewportWidth));
+    const Shader* Program = Resources.Get(UpsampleProgram);
+    Program->SetUniform2f("sourceScale", glm::vec2(float(RenderSize) / GaugeTarget->GetWidth(), float(RenderSize) / GaugeTarget->GetHeight()));
+    GaugeTarget->BindTexture(0);
+    GLCALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+}
 
-    CompassForeground->Bind(0);
-    DrawRectShader->SetUniform1i(rectTexture, 0);
-    DrawRectShader->SetUniformMatrix4f(modelMat, IdentityMat);
-    GLCALL(glDrawElements(GL_TRIANGLES, RectIB->GetCount(), GL_UNSIGNED_INT, 0));
+// On the rendering thread: timer results arrive a frame or two late and are passed on to the main thread
+void Application::CollectGpuTimes()
+{
+    float Ms = 0.f;
+    while (FrameTimer->TakeResult(Ms))
+    {
+        GpuFrameMs = Ms;
+        std::lock_guard<std::mutex> Lock(GpuTimesMutex);
+        GpuTimes.push_back(Ms);
+    }
+}
+
+// Every measurement feeds the scaler, in order
+void Application::UpdateResolutionScale()
+{
+    std::vector<float> Times;
+    {
+        std::lock_guard<std::mutex> Lock(GpuTimesMutex);
+        Times.swap(GpuTimes);
+    }
+    if (DynamicResolution)
+    {
+        for (const float Ms : Times)
+        {
+            Scaler.Update(Ms);
+        }
+    }
+}
+
+Application::FrameState Application::CaptureFrameState() const
+{
+    FrameState State;
+    State.CardHeading = CardDamper.GetHeading();
+    State.TimeSeconds = float(LastFrameTime);
+    // A card driven by a feed that has gone bad is dimmed rather than frozen at full brightness
+    State.CardStale = FollowFeed && FeedConnected && !FeedHeading.IsUsable();
+    State.Transparency = Transparency;
+    State.ViewportWidth = ViewportWidth;
+    State.DynamicResolution = DynamicResolution && GaugeTarget;
+    State.RenderSize = State.DynamicResolution ? std::max(uint(ViewportWidth * Scaler.GetScale() + 0.5f), 1u) : ViewportWidth;
+    return State;
+}
+
+void Application::Draw(const FrameState& State, uint Width, uint Height)
+{
+    TRACE_SCOPE("Draw");
+    QuadVAO->Bind(); // The UI binds its own vertex array
+
+    // Every block of the frame goes up in one write: the frame block, then one block per gauge layer
+    DrawUniforms->BeginFrame();
+    DrawUniforms->Write(FrameBlock.ViewportSize, glm::vec2(float(Width), float(Height)));
+    DrawUniforms->Write(FrameBlock.TimeSeconds, State.TimeSeconds);
+    DrawUniforms->Write(FrameBlock.HeadingDegrees, State.CardHeading);
+
+    const bool CardStale = State.CardStale;
+    for (uint Layer = 0; Layer < GaugeLayerCount; Layer++)
+    {
+        const uint Offset = FrameBlockSize + Layer * GaugeBlockSize;
+        const bool IsCard = Layer == CompassCard;
+        DrawUniforms->Write(Offset + GaugeBlock.Tint, IsCard && CardStale ? glm::vec4(0.6f, 0.6f, 0.6f, 1.f) : glm::vec4(1.f));
+        DrawUniforms->Write(Offset + GaugeBlock.UvRect, GaugeLayerDescs[Layer].UvRect);
+        DrawUniforms->Write(Offset + GaugeBlock.FirstInstance, int(Layer));
+        DrawUniforms->Write(Offset + GaugeBlock.HeadingFollow, GaugeLayerDescs[Layer].FollowsHeading ? 1.f : 0.f);
+    }
+    DrawUniforms->Upload();
+    DrawUniforms->BindRange(FrameBlockBinding, 0, FrameBlock.Size);
+
+    GaugeInstances->Bind(InstanceTextureSlot);
+
+    // Only for the gauges, ImGui sets up its own blending
+    if (State.Transparency == TransparencyMode::Premultiplied)
+    {
+        GLCALL(glEnable(GL_BLEND));
+        GLCALL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    }
+    else if (State.Transparency == TransparencyMode::AlphaToCoverage)
+    {
+        GLCALL(glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE));
+    }
+
+    // Layers sharing a permutation share the program, so it is only switched when it changes
+    const Shader* BoundProgram = nullptr;
+    for (uint Layer = 0; Layer < GaugeLayerCount; Layer++)
+    {
+        const Shader* Program = Resources.Get(GaugeLayers[Layer].Program);
+        if (Program != BoundProgram)
+        {
+            Program->Bind();
+            BoundProgram = Program;
+        }
+
+        DrawUniforms->BindRange(GaugeBlockBinding, FrameBlockSize + Layer * GaugeBlockSize, GaugeBlock.Size);
+        Resources.Get(GaugeLayers[Layer].Image)->Bind(0);
+        GLCALL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 1));
+    }
+
+    GLCALL(glDisable(GL_BLEND));
+    GLCALL(glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE));
 }
 
 void Application::LoadRenderData()
 {
-    float RectVertices[] =
+    TRACE_SCOPE("LoadRenderData");
+
+    // Quads are generated in the vertex shader, so the vertex array has no buffers at all
+    QuadVAO = std::make_shared<VertexArray>();
+    QuadVAO->Bind();
+
+    // Layout read by DrawQuad.vert: the 2x2 part, then the translation padded to a texel. The card
+    // turns in the shader, so the placements only change with the layout.
+    float Texels[GaugeLayerCount * GaugeInstanceTexels * 4] = {};
+    for (uint Layer = 0; Layer < GaugeLayerCount; Layer++)
     {
-        // Position   // TexCoord
-        -1.0f,  1.0f,  0.0f, 1.0f, // top left
-        -1.0f, -1.0f,  0.0f, 0.0f, // bottom left
-         1.0f, -1.0f,  1.0f, 0.0f, // bottom right
-         1.0f,  1.0f,  1.0f, 1.0f  // top right
-    };
+        std::memcpy(&Texels[Layer * GaugeInstanceTexels * 4], Affine2D().Data(), sizeof(Affine2D));
+    }
+    GaugeInstances = std::make_shared<TextureBuffer>(GaugeLayerCount * GaugeInstanceTexels);
+    GaugeInstances->Update(Texels, GaugeLayerCount * GaugeInstanceTexels);
+
+    FrameBlockSize = UniformBuffer::AlignBlock(FrameBlock.Size);
+    GaugeBlockSize = UniformBuffer::AlignBlock(GaugeBlock.Size);
+    DrawUniforms = std::make_shared<UniformBuffer>(FrameBlockSize + GaugeLayerCount * GaugeBlockSize);
+
+    GaugeLayers.resize(GaugeLayerCount);
+    for (uint Layer = 0; Layer < GaugeLayerCount; Layer++)
+    {
+        // Premultiplied before the mipmaps are built, every transparency mode expects it
+        GaugeLayers[Layer].Image = Resources.LoadTexture(GaugeLayerDescs[Layer].TexturePath, true, false, GL_REPEAT, false, true);
+    }
+    LoadGaugePrograms(Transparency);
+
+    if (!Headless)
+    {
+        // Sized for a scale of 1, lower scales only draw into part of it
+        GaugeTarget = std::make_shared<RenderTarget>(ViewportWidth, ViewportWidth, FramebufferSamples);
+        FrameTimer = std::make_shared<GpuTimer>();
+        RetainedUI = std::make_shared<UIRenderer>();
+        UIProgram = Resources.LoadShader("res/shaders/UI.vert", "res/shaders/UI.frag");
+        Resources.Get(UIProgram)->SetUniform1i("uiTexture", 0);
+        UpsampleProgram = Resources.LoadShader("res/shaders/Upsample.vert", "res/shaders/Upsample.frag");
+        Resources.Get(UpsampleProgram)->SetUniform1i("sourceTexture", 0);
+
+        // Budget of most of a refresh interval, the rest is left to the CPU and the compositor. Frames
+        // are paced at the refresh rate.
+        const GLFWvidmode* VideoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        if (VideoMode && VideoMode->refreshRate > 0)
+        {
+            Scaler.TargetMs = 850.f / VideoMode->refreshRate;
+            Pacer.TargetHz = float(VideoMode->refreshRate);
+        }
+    }
+}
 
-    uint RectIndices[] = { 0, 1, 2, 0, 2, 3 };
+// Only the permutations the layers use in the current transparency mode are compiled, each once
+void Application::LoadGaugePrograms(TransparencyMode Mode)
+{
+    TRACE_SCOPE("LoadGaugePrograms");
+    static const char* const ModeDefines[] = { "ALPHA_TEST 0.8", nullptr, "ALPHA_TO_COVERAGE" };
 
-    const int RectVertexCount = sizeof(RectVertices) / sizeof(float);
-    const int RectIndexCount = sizeof(RectIndices) / sizeof(uint);
+    for (uint Layer = 0; Layer < GaugeLayerCount; Layer++)
+    {
+        std::vector<std::string> Defines = GaugeLayerDescs[Layer].Defines;
+        if (const char* ModeDefine = ModeDefines[int(Mode)])
+        {
+            Defines.push_back(ModeDefine);
+        }
 
-    RectVAO = std::make_shared<VertexArray>();
-    RectVAO->Bind();
+        // Released after the new load, so a program the layer keeps is not rebuilt
+        GaugeLayerResources& Resource = GaugeLayers[Layer];
+        const ShaderHandle Previous = Resource.Program;
+        Resource.Program = Resources.LoadShader("res/shaders/DrawQuad.vert", "res/shaders/DrawRect.frag", Defines);
+        Resources.Release(Previous);
 
-    RectVB = std::make_shared<VertexBuffer>(RectVertices, sizeof(float) * RectVertexCount);
-    RectVBL = std::make_shared<VertexBufferLayout>();
-    RectVBL->Push(2); // Position
-    RectVBL->Push(2); // Tex coord
-    RectVAO->AddBuffer(*RectVB.get(), *RectVBL.get());
-    RectIB = std::make_shared<IndexBuffer>(RectIndices, RectIndexCount);
+        Shader* Program = Resources.Get(Resource.Program);
+        Program->BindUniformBlock("FrameBlock", FrameBlockBinding);
+        Program->BindUniformBlock("GaugeBlock", GaugeBlockBinding);
+        Program->SetUniform1i("instances", InstanceTextureSlot);
+        Program->SetUniform1i("rectTexture", 0);
+    }
+}
 
-    DrawRectShader = std::make_shared<Shader>("res/shaders/DrawRect.vert", "res/shaders/DrawRect.frag");
-    CompassBackground = std::make_shared<Texture>("res/textures/CompassBackground.png");
-    CompassForeground = std::make_shared<Texture>("res/textures/CompassForeground.png");
+void Application::SetTransparency(TransparencyMode Mode)
+{
+    if (Mode == Transparency)
+    {
+        return;
+    }
+    Transparency = Mode;
+    SubmitRender([this, Mode]() { LoadGaugePrograms(Mode); });
 }
 
-void Application::SetViewport()
+const char* Application::GetTransparencyName(TransparencyMode Mode)
 {
-    GLCALL(glViewport(0, 0, ViewportWidth, ViewportWidth));
+    switch (Mode)
+    {
+    case TransparencyMode::AlphaTest:
+        return "Alpha test";
+    case TransparencyMode::Premultiplied:
+        return "Premultiplied blend";
+    case TransparencyMode::AlphaToCoverage:
+        return "Alpha to coverage";
+    }
+    return "";
 }
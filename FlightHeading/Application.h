@@ -1,39 +1,209 @@
 #pragma once
 #include "Core.h"
+#include "BoundedQueue.h"
+#include "FileWatcher.h"
+#include "FramePacer.h"
 #include "Helper.h"
+#include "HeadingHistory.h"
+#include "HeadingDamper.h"
+#include "HeadingFeed.h"
+#include "HeadingArbiter.h"
+#include "MagneticModel.h"
+#include "ResolutionScaler.h"
+#include "ResourceRegistry.h"
+#include "UIRenderer.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct ImDrawData;
+struct ImDrawList;
+
+// How the gauge layers' soft edges are drawn, see DrawRect.frag
+enum class TransparencyMode
+{
+	AlphaTest,      // Discard below a threshold: hard, aliased edges
+	Premultiplied,  // Premultiplied alpha blending
+	AlphaToCoverage // Alpha becomes the sample mask, smooth edges on a multisampled target
+};
+
+// GL work of one frame, recorded in order on the main thread and run where the context is current
+using RenderCommandList = std::vector<std::function<void()>>;
 
 class Application
 {
 public:
-	Application();
+	explicit Application(bool InHeadless = false);
 	~Application();
 
 	void Run();
+	// Batch rendering: draws the gauges for Heading into the currently bound framebuffer
+	void RenderFrame(float Heading, uint Width, uint Height);
+
+	// Switches the gauge programs; the permutation is built on first use
+	void SetTransparency(TransparencyMode Mode);
+	inline TransparencyMode GetTransparency() const { return Transparency; }
+	static const char* GetTransparencyName(TransparencyMode Mode);
+	// Render thread mode, see UseRenderThread; takes effect at the next frame of Run
+	inline void SetRenderThread(bool Enabled) { UseRenderThread = Enabled; }
+	// Rasterizes the fonts listed in res/fonts into the atlas the UI loads at startup; needs no window
+	static bool BakeFonts();
 private:
+	// What a frame's GL work needs from the main thread, copied so the render thread never reads
+	// state the main thread is already changing for the next frame
+	struct FrameState
+	{
+		float CardHeading = 0.f;
+		float TimeSeconds = 0.f;
+		bool CardStale = false;
+		TransparencyMode Transparency = TransparencyMode::Premultiplied;
+		uint ViewportWidth = 0;
+		bool DynamicResolution = false;
+		uint RenderSize = 0; // Gauge pass size, ViewportWidth unless scaled
+	};
+
+	// ImGui reuses its draw lists every frame, so a frame handed to the render thread renders a copy
+	struct UIDrawDataCopy
+	{
+		std::vector<ImDrawList*> Lists; // Allocated on the main thread and reused
+		std::shared_ptr<ImDrawData> Data;
+	};
+
+	const bool Headless; // Hidden window and no UI, for offscreen rendering
 	uint WindowWidth = 600;
 	uint WindowHeight = WindowWidth;
 	uint ViewportWidth = WindowWidth; // Keeping the viewport square
 	GLFWwindow* Window = nullptr;
+	int MsaaSamples = 4;        // Asked for on the window
+	int FramebufferSamples = 0; // What the window got
+	TransparencyMode Transparency = TransparencyMode::Premultiplied;
 	const float MinHeading = 0.f;
 	const float MaxHeading = 359.f;
-	float CurrentHeading = MinHeading;
+	float CurrentHeading = MinHeading; // Latest magnetic heading from the slider or the feed
+	HeadingDamper CardDamper;          // What the gauge shows, following the target heading
+	double LastFrameTime = 0.0;
 	glm::vec4 ClearColor = glm::vec4(0.25f, 0.3f, 0.3f, 1.0f);
-	std::shared_ptr<VertexArray> RectVAO;
-	std::shared_ptr<VertexBuffer> RectVB;
-	std::shared_ptr<IndexBuffer> RectIB;
-	std::shared_ptr<VertexBufferLayout> RectVBL;
-	std::shared_ptr<Shader> DrawRectShader;
-	std::shared_ptr<Texture> CompassBackground;
-	std::shared_ptr<Texture> CompassForeground;
+	std::shared_ptr<VertexArray> QuadVAO; // Empty, the core profile only draws with a vertex array bound
+	std::shared_ptr<TextureBuffer> GaugeInstances;
+	std::shared_ptr<UniformBuffer> DrawUniforms; // Frame block, then one block per gauge layer
+	uint FrameBlockSize = 0;                     // Both aligned for glBindBufferRange
+	uint GaugeBlockSize = 0;
+	ResourceRegistry Resources;
+	FileWatcher ResourceWatcher; // res/, for hot reloading shaders and textures
+	struct GaugeLayerResources
+	{
+		TextureHandle Image;
+		ShaderHandle Program; // The permutation the layer needs
+	};
+	std::vector<GaugeLayerResources> GaugeLayers; // In GaugeLayer order, see Application.cpp
+	HeadingHistory History;
+	float HistoryWindowSeconds = 60.f;
+	std::vector<SeriesBucket> PlotBuckets;
+	HeadingArbiter Arbiter{ 3 }; // AHRS 1, AHRS 2 and the standby
+	ArbitratedHeading FeedHeading;
+	bool FollowFeed = true;
+	std::thread FeedThread;
+	std::atomic<bool> FeedThreadRunning{ false };
+	std::atomic<bool> FeedConnected{ false };
+	static constexpr uint FeedIdlePollMs = 20; // Feed poll interval while the pacer is idle, well inside the stale timeout
+	DeclinationGrid Declination;
+	bool ShowTrueHeading = false;
+	float Latitude = 47.45f;    // Degrees north
+	float Longitude = -122.31f; // Degrees east
+	float Variation = 0.f;      // Degrees east at the current position
+	float MemoryBudgetMB = 64.f; // GPU memory before unused textures are evicted, 0 for no limit
+	// Dynamic resolution: the gauges render into GaugeTarget at a scale that follows the GPU frame
+	// time, then are stretched over the viewport; ImGui always draws at native resolution
+	bool DynamicResolution = true;
+	ResolutionScaler Scaler;
+	std::shared_ptr<RenderTarget> GaugeTarget; // ViewportWidth square, drawn into its scaled corner
+	std::shared_ptr<GpuTimer> FrameTimer;
+	ShaderHandle UpsampleProgram;
+	std::atomic<float> GpuFrameMs{ 0.f }; // Latest measurement
+	// Frame pacing: the pacer starts every frame, and drops to its idle rate once the card has been
+	// still and there has been no input for IdleAfterSeconds
+	FramePacer Pacer;
+	bool VSync = true;
+	bool LowPower = true;
+	float IdleAfterSeconds = 2.f;
+	float StableDegrees = 0.05f; // Card movement below this counts as still
+	float PacedHeading = 0.f;    // Target heading when the last frame started
+	double LastActivityTime = 0.0;
+	bool InputPending = false;   // Set by the GLFW input callbacks
+	// Render thread mode: the main thread polls events, runs the UI and records each frame into
+	// Recording; the render thread owns the GL context and runs the lists from RenderQueue, so
+	// recording frame N+1 overlaps submitting and swapping frame N. Switched between frames.
+	static constexpr uint RenderQueueDepth = 1; // Frames recorded ahead of the one being submitted
+	bool UseRenderThread = false;
+	bool RenderThreadRunning = false;
+	std::thread RenderThread;
+	RenderCommandList Recording;
+	BoundedQueue<RenderCommandList> RenderQueue{ RenderQueueDepth };
+	// One more than can be in flight: queued, being submitted, and the one being recorded
+	UIDrawDataCopy UICopies[RenderQueueDepth + 2];
+	uint NextUICopy = 0;
+	// Retained UI: the Control Panel is rebuilt on input and for a few frames after, otherwise only
+	// UIRefreshHz times a second for its live readouts. Draw data that hashes like the last upload
+	// is drawn from RetainedUI's buffers without being copied or uploaded again.
+	static constexpr uint UIFramesAfterInput = 3;
+	bool RetainUI = true;
+	float UIRefreshHz = 10.f;
+	uint UIRebuildFrames = UIFramesAfterInput;
+	double LastUIBuildTime = 0.0;
+	uint64_t SubmittedUIHash = 0; // What RetainedUI holds once the submitted frames have run
+	std::shared_ptr<UIRenderer> RetainedUI;
+	ShaderHandle UIProgram;
+	struct UICacheStats
+	{
+		uint Frames = 0, Rebuilds = 0, Uploads = 0;
+	};
+	UICacheStats UIStatsCounting;  // This second so far
+	UICacheStats UIStatsLast;      // The last whole second
+	double UIStatsStart = 0.0;
+	std::mutex GpuTimesMutex;
+	std::vector<float> GpuTimes; // Measured by whichever thread renders, fed to the Scaler by the main thread
 
 	void CreateWindow();
 	void InitUI();
+	void LoadFonts();
 	void BeginUIFrame();
 	void EndUIFrame();
+	void SubmitUI(double FrameTime);
 	void FrameBufferSizeCallback(GLFWwindow* Window, int Width, int Height);
 	void RenderUI(GLFWwindow* Window);
+	void RenderHistoryUI();
+	void RenderFeedUI();
+	void RenderTraceUI();
+	void RenderMemoryUI();
+	void RenderResolutionUI();
+	void RenderPacingUI();
+	void RenderThreadingUI();
+	void RenderUICacheUI();
+	void UpdateFeed();
+	void FeedLoop();
+	void LoadMagneticModel();
+	void RenderHeadingReferenceUI();
+	float GetTargetHeading() const;
+	void ReloadChangedResources();
+	void Update(float DeltaSeconds);
 	void ClearWindow();
-	void Draw();
+	FrameState CaptureFrameState() const;
+	void Draw(const FrameState& State, uint Width, uint Height);
+	void DrawGauges(const FrameState& State);
+	void DrawUI(ImDrawData* DrawData, uint64_t DataHash);
+	void CollectGpuTimes();
+	void UpdateResolutionScale();
+	// Runs Command now, or records it for the render thread when there is one
+	void SubmitRender(std::function<void()> Command);
+	void EndFrame();
+	void StartRenderThread();
+	void StopRenderThread();
+	void RenderLoop();
+	ImDrawData* CopyDrawData(const ImDrawData* Source);
+	void PaceFrame();
+	bool HasActivity() const;
 	void LoadRenderData();
-	void SetViewport();
+	void LoadGaugePrograms(TransparencyMode Mode);
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "Core.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO of at most Capacity items between threads. Push waits while it is full, which is
+// what keeps a producer from running more than Capacity items ahead; Pop waits while it is empty.
+// Close wakes both: Push then refuses items and Pop returns what is left before reporting the end.
+template<typename T>
+class BoundedQueue : public Useful::NonCopyable
+{
+public:
+	explicit BoundedQueue(size_t InCapacity) : Capacity(std::max<size_t>(InCapacity, 1)) {}
+
+	bool Push(T Item)
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		NotFull.wait(Lock, [this]() { return Closed || Items.size() < Capacity; });
+		if (Closed)
+		{
+			return false;
+		}
+		Items.push_back(std::move(Item));
+		NotEmpty.notify_one();
+		return true;
+	}
+
+	// False once the queue is closed and empty
+	bool Pop(T& OutItem)
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		NotEmpty.wait(Lock, [this]() { return Closed || !Items.empty(); });
+		if (Items.empty())
+		{
+			return false;
+		}
+		OutItem = std::move(Items.front());
+		Items.pop_front();
+		NotFull.notify_one();
+		return true;
+	}
+
+	void Close()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Closed = true;
+		NotFull.notify_all();
+		NotEmpty.notify_all();
+	}
+
+	// Accepts items again after Close, for a consumer that is restarted
+	void Reopen()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Closed = false;
+	}
+
+	inline size_t GetCapacity() const { return Capacity; }
+
+private:
+	std::mutex Mutex;
+	std::condition_variable NotFull;
+	std::condition_variable NotEmpty;
+	std::deque<T> Items;
+	const size_t Capacity;
+	bool Closed = false;
+};
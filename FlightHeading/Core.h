@@ -10,8 +10,15 @@ typedef unsigned char uchar;
 template<typename T>
 using CRef = const T&;
 
+#ifdef _MSC_VER
+#define DEBUGBREAK() __debugbreak()
+#else
+#include <csignal>
+#define DEBUGBREAK() std::raise(SIGTRAP)
+#endif
+
 #ifdef _DEBUG
-#define ASSERT(x) if(!(x)) __debugbreak()
+#define ASSERT(x) if(!(x)) DEBUGBREAK()
 #else
 #define ASSERT(x)
 #endif // _DEBUG
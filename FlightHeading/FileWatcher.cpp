@@ -0,0 +1,226 @@
+#include "FileWatcher.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+std::vector<std::string> FileWatcher::TakeChanges()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	std::vector<std::string> Out;
+	Out.swap(Changes);
+	return Out;
+}
+
+void FileWatcher::AddChange(const std::string& Path)
+{
+	// Editors often write a file in several steps, each reported on its own
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if (std::find(Changes.begin(), Changes.end(), Path) == Changes.end())
+	{
+		Changes.push_back(Path);
+	}
+}
+
+#ifdef _WIN32
+bool FileWatcher::Start(const std::string& InDirectory)
+{
+	Stop();
+	Directory = InDirectory;
+	DirectoryHandle = CreateFileA(Directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (DirectoryHandle == INVALID_HANDLE_VALUE)
+	{
+		DirectoryHandle = nullptr;
+		std::cout << "Could not watch " << Directory << std::endl;
+		return false;
+	}
+	StopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+	Running = true;
+	Worker = std::thread(&FileWatcher::WatchLoop, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (!Worker.joinable())
+	{
+		return;
+	}
+
+	// The loop waits on the read and this event together, so it wakes whether or not a read is pending
+	Running = false;
+	SetEvent(StopEvent);
+	Worker.join();
+	CloseHandle(StopEvent);
+	StopEvent = nullptr;
+	CloseHandle(DirectoryHandle);
+	DirectoryHandle = nullptr;
+}
+
+void FileWatcher::WatchLoop()
+{
+	alignas(DWORD) char Buffer[16 * 1024];
+	OVERLAPPED Overlapped = {};
+	Overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	while (Running)
+	{
+		DWORD Bytes = 0;
+		if (!ReadDirectoryChangesW(DirectoryHandle, Buffer, sizeof(Buffer), TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &Overlapped, nullptr))
+		{
+			break;
+		}
+
+		const HANDLE Waits[2] = { Overlapped.hEvent, StopEvent };
+		if (WaitForMultipleObjects(2, Waits, FALSE, INFINITE) != WAIT_OBJECT_0)
+		{
+			// Stopping: the read still owns Buffer until its cancellation completes
+			CancelIoEx(DirectoryHandle, &Overlapped);
+			GetOverlappedResult(DirectoryHandle, &Overlapped, &Bytes, TRUE);
+			break;
+		}
+		if (!GetOverlappedResult(DirectoryHandle, &Overlapped, &Bytes, FALSE))
+		{
+			break;
+		}
+
+		for (DWORD Offset = 0; Bytes > 0;)
+		{
+			const FILE_NOTIFY_INFORMATION* Info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(Buffer + Offset);
+			if (Info->Action == FILE_ACTION_MODIFIED || Info->Action == FILE_ACTION_ADDED || Info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+			{
+				const int Length = WideCharToMultiByte(CP_UTF8, 0, Info->FileName, int(Info->FileNameLength / sizeof(WCHAR)), nullptr, 0, nullptr, nullptr);
+				std::string Name(size_t(Length), '\0');
+				WideCharToMultiByte(CP_UTF8, 0, Info->FileName, int(Info->FileNameLength / sizeof(WCHAR)), &Name[0], Length, nullptr, nullptr);
+				std::replace(Name.begin(), Name.end(), '\\', '/');
+				AddChange(Directory + '/' + Name);
+			}
+
+			if (Info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			Offset += Info->NextEntryOffset;
+		}
+	}
+	CloseHandle(Overlapped.hEvent);
+}
+#else
+namespace
+{
+	constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+	// Watches Path and every directory under it, remembering which directory each watch is
+	void AddWatches(int Inotify, const std::string& Path, std::unordered_map<int, std::string>& Watches)
+	{
+		const int Watch = inotify_add_watch(Inotify, Path.c_str(), WatchMask);
+		if (Watch < 0)
+		{
+			return;
+		}
+		Watches[Watch] = Path;
+
+		DIR* Dir = opendir(Path.c_str());
+		if (!Dir)
+		{
+			return;
+		}
+		while (const dirent* Entry = readdir(Dir))
+		{
+			const std::string Name = Entry->d_name;
+			if (Entry->d_type == DT_DIR && Name != "." && Name != "..")
+			{
+				AddWatches(Inotify, Path + '/' + Name, Watches);
+			}
+		}
+		closedir(Dir);
+	}
+}
+
+bool FileWatcher::Start(const std::string& InDirectory)
+{
+	Stop();
+	Directory = InDirectory;
+	Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (Inotify < 0)
+	{
+		std::cout << "Could not watch " << Directory << std::endl;
+		return false;
+	}
+
+	Running = true;
+	Worker = std::thread(&FileWatcher::WatchLoop, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (!Worker.joinable())
+	{
+		return;
+	}
+
+	// The loop polls with a timeout, so it sees this within one
+	Running = false;
+	Worker.join();
+	close(Inotify);
+	Inotify = -1;
+}
+
+void FileWatcher::WatchLoop()
+{
+	std::unordered_map<int, std::string> Watches;
+	AddWatches(Inotify, Directory, Watches);
+
+	alignas(inotify_event) char Buffer[16 * 1024];
+	while (Running)
+	{
+		pollfd Poll = { Inotify, POLLIN, 0 };
+		if (poll(&Poll, 1, 100) <= 0)
+		{
+			continue;
+		}
+
+		const ssize_t Bytes = read(Inotify, Buffer, sizeof(Buffer));
+		for (ssize_t Offset = 0; Offset < Bytes;)
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			Offset += sizeof(inotify_event) + Event->len;
+
+			auto Found = Watches.find(Event->wd);
+			if (Found == Watches.end() || Event->len == 0)
+			{
+				continue;
+			}
+
+			const std::string Path = Found->second + '/' + Event->name;
+			if (Event->mask & IN_ISDIR)
+			{
+				if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					AddWatches(Inotify, Path, Watches);
+				}
+			}
+			else if (Event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			{
+				// IN_CREATE alone is an empty file that is about to be written
+				AddChange(Path);
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a directory tree on a background thread (inotify on Linux, ReadDirectoryChangesW on
+// Windows) and collects the files that were written, for the render loop to pick up between frames.
+class FileWatcher : public Useful::NonCopyable
+{
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+
+	bool Start(const std::string& InDirectory);
+	void Stop();
+	inline bool IsWatching() const { return Running; }
+
+	// Files written since the last call, each once, as Directory + '/' + the path under it
+	std::vector<std::string> TakeChanges();
+
+private:
+	std::string Directory;
+	std::thread Worker;
+	std::atomic<bool> Running{ false };
+	std::mutex Mutex;
+	std::vector<std::string> Changes;
+#ifdef _WIN32
+	void* DirectoryHandle = nullptr;
+	void* StopEvent = nullptr;
+#else
+	int Inotify = -1;
+#endif
+
+	void AddChange(const std::string& Path);
+	void WatchLoop();
+};
@@ -0,0 +1,403 @@
+#include "FontAtlasBake.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	constexpr char AtlasMagic[4] = { 'F', 'H', 'F', 'A' };
+	constexpr uint32_t AtlasVersion = 1;
+
+	struct AtlasHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t FontCount;
+		uint32_t RectCount;  // Custom rectangles, the white pixel, cursors and line textures among them
+		uint32_t LineCount;  // Baked anti-aliased line UVs
+		int32_t PackIdMouseCursors;
+		int32_t PackIdLines;
+		float WhitePixelU, WhitePixelV;
+		uint32_t Reserved;
+	};
+	static_assert(sizeof(AtlasHeader) == 56, "Atlas header layout changed");
+
+	struct RectRecord
+	{
+		uint16_t X, Y, Width, Height;
+	};
+
+	struct FontRecord
+	{
+		char Name[40];
+		float SizePixels;
+		float Ascent, Descent;
+		uint32_t EllipsisChar;
+		uint32_t GlyphCount;
+	};
+	static_assert(sizeof(FontRecord) == 60, "Font record layout changed");
+
+	struct GlyphRecord
+	{
+		uint32_t Codepoint;
+		uint32_t Visible;
+		uint32_t Colored;
+		float AdvanceX;
+		float X0, Y0, X1, Y1;
+		float U0, V0, U1, V1;
+	};
+	static_assert(sizeof(GlyphRecord) == 48, "Glyph record layout changed");
+
+	uint64_t HashBytes(uint64_t Hash, const void* Data, size_t Size)
+	{
+		const uchar* Bytes = static_cast<const uchar*>(Data);
+		for (size_t i = 0; i < Size; i++)
+		{
+			Hash = (Hash ^ Bytes[i]) * 0x100000001b3ull;
+		}
+		return Hash;
+	}
+
+	// Bounds checked reads from the mapped file
+	class Reader
+	{
+	public:
+		Reader(const uchar* InData, size_t InSize) : Data(InData), Size(InSize) {}
+
+		const uchar* Take(size_t Bytes)
+		{
+			if (Bytes > Size - Offset)
+			{
+				return nullptr;
+			}
+			const uchar* Result = Data + Offset;
+			Offset += Bytes;
+			return Result;
+		}
+
+		template<typename T>
+		bool Read(T& Out)
+		{
+			const uchar* Bytes = Take(sizeof(T));
+			if (Bytes)
+			{
+				std::memcpy(&Out, Bytes, sizeof(T));
+			}
+			return Bytes != nullptr;
+		}
+
+		inline bool AtEnd() const { return Offset == Size; }
+
+	private:
+		const uchar* Data;
+		size_t Size;
+		size_t Offset = 0;
+	};
+}
+
+// Begin- FontBakeConfig
+bool FontBakeConfig::Load(const std::string& Path)
+{
+	std::ifstream Stream(Path, std::ios::binary);
+	if (!Stream.is_open())
+	{
+		return false;
+	}
+	std::stringstream Text;
+	Text << Stream.rdbuf();
+	const std::string Contents = Text.str();
+
+	Sources.clear();
+	const int ImGuiVersion = IMGUI_VERSION_NUM;
+	Key = HashBytes(0xcbf29ce484222325ull, &ImGuiVersion, sizeof(ImGuiVersion));
+	Key = HashBytes(Key, Contents.data(), Contents.size());
+
+	std::istringstream Lines(Contents);
+	std::string Line;
+	uint LineNumber = 0;
+	while (std::getline(Lines, Line))
+	{
+		LineNumber++;
+		std::istringstream Fields(Line);
+		std::string Keyword;
+		if (!(Fields >> Keyword) || Keyword[0] == '#')
+		{
+			continue;
+		}
+
+		if (Keyword == "font")
+		{
+			Source NewSource;
+			std::string Option;
+			if (!(Fields >> NewSource.Path >> NewSource.SizePixels) || NewSource.SizePixels <= 0.f)
+			{
+				std::cout << Path << ":" << LineNumber << ": expected font <path> <size>" << std::endl;
+				return false;
+			}
+			NewSource.Merge = (Fields >> Option) && Option == "merge";
+			if (NewSource.Merge && Sources.empty())
+			{
+				std::cout << Path << ":" << LineNumber << ": the first font cannot be merged" << std::endl;
+				return false;
+			}
+			Sources.push_back(NewSource);
+		}
+		else if (Keyword == "range")
+		{
+			uint First = 0, Last = 0;
+			if (Sources.empty() || !(Fields >> std::hex >> First >> Last) || First == 0 || First > Last || Last > IM_UNICODE_CODEPOINT_MAX)
+			{
+				std::cout << Path << ":" << LineNumber << ": expected range <first> <last> after a font" << std::endl;
+				return false;
+			}
+			Sources.back().Ranges.push_back(ImWchar(First));
+			Sources.back().Ranges.push_back(ImWchar(Last));
+		}
+		else
+		{
+			std::cout << Path << ":" << LineNumber << ": unknown keyword " << Keyword << std::endl;
+			return false;
+		}
+	}
+
+	if (Sources.empty())
+	{
+		std::cout << "No fonts in " << Path << std::endl;
+		return false;
+	}
+
+	for (Source& FontSource : Sources)
+	{
+		if (!FontSource.Ranges.empty())
+		{
+			FontSource.Ranges.push_back(0);
+		}
+		if (FontSource.Path == "default")
+		{
+			continue;
+		}
+
+		// A changed font file makes the baked atlas stale as well
+		MappedFile File;
+		if (!File.Open(FontSource.Path))
+		{
+			std::cout << "Could not open font " << FontSource.Path << std::endl;
+			return false;
+		}
+		Key = HashBytes(Key, File.GetData(), File.GetSize());
+	}
+	return true;
+}
+
+void FontBakeConfig::AddTo(ImFontAtlas& Atlas) const
+{
+	for (const Source& FontSource : Sources)
+	{
+		ImFontConfig Font;
+		Font.SizePixels = FontSource.SizePixels;
+		Font.MergeMode = FontSource.Merge;
+		Font.GlyphRanges = FontSource.Ranges.empty() ? nullptr : FontSource.Ranges.data();
+		if (FontSource.Path == "default")
+		{
+			// What AddFontDefault picks for the pixel font when given no config
+			Font.OversampleH = Font.OversampleV = 1;
+			Font.PixelSnapH = true;
+			Atlas.AddFontDefault(&Font);
+		}
+		else
+		{
+			Atlas.AddFontFromFileTTF(FontSource.Path.c_str(), FontSource.SizePixels, &Font, Font.GlyphRanges);
+		}
+	}
+}
+// End- FontBakeConfig
+
+// Begin- FontAtlasBake
+bool FontAtlasBake::Build(const FontBakeConfig& Config, const std::string& Path)
+{
+	TRACE_SCOPE("BakeFontAtlas");
+	ImFontAtlas Atlas;
+	Config.AddTo(Atlas);
+	uchar* Pixels = nullptr;
+	int Width = 0, Height = 0;
+	if (!Atlas.Build() || (Atlas.GetTexDataAsAlpha8(&Pixels, &Width, &Height), Pixels == nullptr))
+	{
+		std::cout << "Could not rasterize the fonts for " << Path << std::endl;
+		return false;
+	}
+
+	AtlasHeader Header;
+	std::memcpy(Header.Magic, AtlasMagic, sizeof(AtlasMagic));
+	Header.Version = AtlasVersion;
+	Header.Key = Config.Key;
+	Header.Width = uint32_t(Width);
+	Header.Height = uint32_t(Height);
+	Header.FontCount = uint32_t(Atlas.Fonts.Size);
+	Header.RectCount = uint32_t(Atlas.CustomRects.Size);
+	Header.LineCount = IM_ARRAYSIZE(Atlas.TexUvLines);
+	Header.PackIdMouseCursors = Atlas.PackIdMouseCursors;
+	Header.PackIdLines = Atlas.PackIdLines;
+	Header.WhitePixelU = Atlas.TexUvWhitePixel.x;
+	Header.WhitePixelV = Atlas.TexUvWhitePixel.y;
+	Header.Reserved = 0;
+
+	std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		std::cout << "Could not write font atlas: " << Path << std::endl;
+		return false;
+	}
+	Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	for (const ImFontAtlasCustomRect& Rect : Atlas.CustomRects)
+	{
+		const RectRecord Record = { Rect.X, Rect.Y, Rect.Width, Rect.Height };
+		Stream.write(reinterpret_cast<const char*>(&Record), sizeof(Record));
+	}
+	Stream.write(reinterpret_cast<const char*>(Atlas.TexUvLines), sizeof(Atlas.TexUvLines));
+
+	for (const ImFont* Font : Atlas.Fonts)
+	{
+		FontRecord Record = {};
+		std::memcpy(Record.Name, Font->Sources->Name, sizeof(Record.Name));
+		Record.SizePixels = Font->FontSize;
+		Record.Ascent = Font->Ascent;
+		Record.Descent = Font->Descent;
+		Record.EllipsisChar = Font->Sources->EllipsisChar;
+		Record.GlyphCount = uint32_t(Font->Glyphs.Size);
+		Stream.write(reinterpret_cast<const char*>(&Record), sizeof(Record));
+		for (const ImFontGlyph& Glyph : Font->Glyphs)
+		{
+			const GlyphRecord GlyphData = { Glyph.Codepoint, Glyph.Visible, Glyph.Colored, Glyph.AdvanceX,
+				Glyph.X0, Glyph.Y0, Glyph.X1, Glyph.Y1, Glyph.U0, Glyph.V0, Glyph.U1, Glyph.V1 };
+			Stream.write(reinterpret_cast<const char*>(&GlyphData), sizeof(GlyphData));
+		}
+	}
+	Stream.write(reinterpret_cast<const char*>(Pixels), size_t(Width) * Height);
+	return Stream.good();
+}
+
+bool FontAtlasBake::Load(const std::string& Path, const FontBakeConfig& Config, ImFontAtlas& Atlas)
+{
+	TRACE_SCOPE("LoadFontAtlas");
+	MappedFile File;
+	if (!File.Open(Path))
+	{
+		return false;
+	}
+
+	Reader In(File.GetData(), File.GetSize());
+	AtlasHeader Header;
+	if (!In.Read(Header) || std::memcmp(Header.Magic, AtlasMagic, sizeof(AtlasMagic)) != 0 || Header.Version != AtlasVersion
+		|| Header.LineCount != IM_ARRAYSIZE(Atlas.TexUvLines) || Header.FontCount == 0 || Header.Width == 0 || Header.Height == 0)
+	{
+		std::cout << "Not a font atlas: " << Path << std::endl;
+		return false;
+	}
+	if (Header.Key != Config.Key)
+	{
+		return false;
+	}
+
+	std::vector<RectRecord> Rects(Header.RectCount);
+	ImVec4 Lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+	const uchar* RectData = In.Take(Rects.size() * sizeof(RectRecord));
+	if (!RectData || !In.Read(Lines))
+	{
+		std::cout << "Truncated font atlas: " << Path << std::endl;
+		return false;
+	}
+	std::memcpy(Rects.data(), RectData, Rects.size() * sizeof(RectRecord));
+
+	// Everything is read into a local atlas first so a bad file leaves Atlas as it was
+	ImFontAtlas Baked;
+	for (uint i = 0; i < Header.FontCount; i++)
+	{
+		FontRecord Record;
+		if (!In.Read(Record) || Record.GlyphCount == 0 || Record.GlyphCount >= 0xFFFF)
+		{
+			std::cout << "Truncated font atlas: " << Path << std::endl;
+			return false;
+		}
+
+		ImFontConfig Source;
+		std::memcpy(Source.Name, Record.Name, sizeof(Source.Name));
+		Source.Name[sizeof(Source.Name) - 1] = '\0';
+		Source.SizePixels = Record.SizePixels;
+		Source.EllipsisChar = ImWchar(Record.EllipsisChar);
+		Source.FontDataOwnedByAtlas = false;
+		Baked.Sources.push_back(Source);
+
+		ImFont* Font = IM_NEW(ImFont);
+		Baked.Fonts.push_back(Font);
+		Font->ContainerAtlas = &Baked;
+		Font->FontSize = Record.SizePixels;
+		Font->Ascent = Record.Ascent;
+		Font->Descent = Record.Descent;
+		Font->Glyphs.resize(int(Record.GlyphCount));
+		for (ImFontGlyph& Glyph : Font->Glyphs)
+		{
+			GlyphRecord GlyphData;
+			if (!In.Read(GlyphData))
+			{
+				std::cout << "Truncated font atlas: " << Path << std::endl;
+				return false;
+			}
+			Glyph.Codepoint = GlyphData.Codepoint;
+			Glyph.Visible = GlyphData.Visible;
+			Glyph.Colored = GlyphData.Colored;
+			Glyph.AdvanceX = GlyphData.AdvanceX;
+			Glyph.X0 = GlyphData.X0; Glyph.Y0 = GlyphData.Y0; Glyph.X1 = GlyphData.X1; Glyph.Y1 = GlyphData.Y1;
+			Glyph.U0 = GlyphData.U0; Glyph.V0 = GlyphData.V0; Glyph.U1 = GlyphData.U1; Glyph.V1 = GlyphData.V1;
+		}
+	}
+
+	const size_t PixelBytes = size_t(Header.Width) * Header.Height;
+	const uchar* Pixels = In.Take(PixelBytes);
+	if (!Pixels || !In.AtEnd())
+	{
+		std::cout << "Truncated font atlas: " << Path << std::endl;
+		return false;
+	}
+
+	// Only now is Atlas replaced, sources are linked once the vector no longer grows
+	Atlas.Clear();
+	Atlas.Sources.swap(Baked.Sources);
+	Atlas.Fonts.swap(Baked.Fonts);
+	for (int i = 0; i < Atlas.Fonts.Size; i++)
+	{
+		ImFont* Font = Atlas.Fonts[i];
+		Atlas.Sources[i].DstFont = Font;
+		Font->ContainerAtlas = &Atlas;
+		Font->Sources = &Atlas.Sources[i];
+		Font->SourcesCount = 1;
+		Font->BuildLookupTable();
+	}
+	for (const RectRecord& Record : Rects)
+	{
+		ImFontAtlasCustomRect Rect;
+		Rect.X = Record.X;
+		Rect.Y = Record.Y;
+		Rect.Width = Record.Width;
+		Rect.Height = Record.Height;
+		Atlas.CustomRects.push_back(Rect);
+	}
+	Atlas.PackIdMouseCursors = Header.PackIdMouseCursors;
+	Atlas.PackIdLines = Header.PackIdLines;
+	std::memcpy(Atlas.TexUvLines, Lines, sizeof(Lines));
+
+	Atlas.TexWidth = int(Header.Width);
+	Atlas.TexHeight = int(Header.Height);
+	Atlas.TexUvScale = ImVec2(1.f / Atlas.TexWidth, 1.f / Atlas.TexHeight);
+	Atlas.TexUvWhitePixel = ImVec2(Header.WhitePixelU, Header.WhitePixelV);
+	Atlas.TexPixelsAlpha8 = static_cast<uchar*>(IM_ALLOC(PixelBytes));
+	std::memcpy(Atlas.TexPixelsAlpha8, Pixels, PixelBytes);
+	Atlas.TexReady = true;
+	return true;
+}
+// End- FontAtlasBake
@@ -0,0 +1,39 @@
+#pragma once
+#include "Core.h"
+#include <imgui/imgui.h>
+#include <string>
+#include <vector>
+
+// The UI fonts and the glyphs baked for each, read from a text file of lines
+//   font default|<ttf path> <size in pixels> [merge]
+//   range <first> <last>
+// with ranges as inclusive hex code points belonging to the font line above. A font without
+// ranges gets Basic Latin and Latin-1; "merge" adds its glyphs to the font before it, for icons.
+struct FontBakeConfig
+{
+	struct Source
+	{
+		std::string Path;
+		float SizePixels = 13.f;
+		bool Merge = false;
+		std::vector<ImWchar> Ranges; // Pairs, 0 terminated
+	};
+
+	std::vector<Source> Sources;
+	uint64_t Key = 0; // Of the config text, the font files and the ImGui version
+
+	bool Load(const std::string& Path);
+	// Adds the sources to Atlas, to be rasterized by its Build. The ranges must outlive that.
+	void AddTo(ImFontAtlas& Atlas) const;
+};
+
+// A font atlas rasterized once and stored with its glyph tables, so startup copies the pixels and
+// glyphs into ImGui instead of running stb_truetype over every glyph in every range. A file built
+// from another config, font or ImGui version is refused and has to be built again.
+namespace FontAtlasBake
+{
+	// Rasterizes Config and writes the atlas to Path
+	bool Build(const FontBakeConfig& Config, const std::string& Path);
+	// Replaces the fonts of Atlas with the ones baked in Path, leaving it built
+	bool Load(const std::string& Path, const FontBakeConfig& Config, ImFontAtlas& Atlas);
+}
@@ -0,0 +1,140 @@
+#include "FramePacer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#endif
+#endif
+
+FramePacer::FramePacer()
+{
+#ifdef _WIN32
+	// Sleeps otherwise round up to the 15.6 ms default timer tick
+	timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::Reset()
+{
+	Started = false;
+	Missed = 0;
+	HistoryCount = 0;
+	HistoryNext = 0;
+}
+
+void FramePacer::SetIdle(bool InIdle)
+{
+	Idle = InIdle;
+}
+
+void FramePacer::Wait(const std::function<bool()>& WakeEarly)
+{
+	TRACE_SCOPE("Pace");
+	const float Hz = Idle ? IdleHz : TargetHz;
+	Clock::time_point Now = Clock::now();
+	if (Hz <= 0.f)
+	{
+		if (!Started)
+		{
+			LastFrameStart = Now;
+			Started = true;
+		}
+		Deadline = Now;
+		RecordFrame(Now);
+		return;
+	}
+
+	const Clock::duration Interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / Hz));
+	if (!Started)
+	{
+		Deadline = Now;
+		LastFrameStart = Now;
+		Started = true;
+	}
+	Deadline += Interval;
+	if (Now > Deadline + Interval)
+	{
+		Deadline = Now;
+		Missed++;
+	}
+
+	const Clock::duration Spin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(SpinMs));
+	const Clock::duration WakeCheck = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(WakeCheckMs));
+	for (Now = Clock::now(); Now < Deadline - Spin; Now = Clock::now())
+	{
+		const bool CheckWake = Idle && WakeEarly;
+		std::this_thread::sleep_for(CheckWake ? std::min(Deadline - Spin - Now, WakeCheck) : Deadline - Spin - Now);
+		if (CheckWake && WakeEarly())
+		{
+			Idle = false;
+			Deadline = Clock::now();
+			break;
+		}
+	}
+	while (Clock::now() < Deadline)
+	{
+		std::this_thread::yield();
+	}
+	RecordFrame(Clock::now());
+}
+
+void FramePacer::RecordFrame(Clock::time_point Start)
+{
+	const float IntervalMs = std::chrono::duration<float, std::milli>(Start - LastFrameStart).count();
+	const float LateMs = std::max(std::chrono::duration<float, std::milli>(Start - Deadline).count(), 0.f);
+	LastFrameStart = Start;
+
+	// The first frame after idle is timed from an idle one, and idle frames are not what is paced
+	const bool Counted = !Idle && !LastFrameIdle;
+	LastFrameIdle = Idle;
+	if (!Counted)
+	{
+		return;
+	}
+
+	TRACE_COUNTER("Frame interval (ms)", IntervalMs);
+	TRACE_COUNTER("Pacing lateness (ms)", LateMs);
+	Intervals[HistoryNext] = IntervalMs;
+	Lateness[HistoryNext] = LateMs;
+	HistoryNext = (HistoryNext + 1) % HistorySize;
+	HistoryCount = std::min(HistoryCount + 1, HistorySize);
+}
+
+PacingStats FramePacer::GetStats() const
+{
+	PacingStats Stats;
+	Stats.TargetIntervalMs = TargetHz > 0.f ? 1000.f / TargetHz : 0.f;
+	Stats.Missed = Missed;
+	if (HistoryCount == 0)
+	{
+		return Stats;
+	}
+
+	double IntervalSum = 0.0, IntervalSquares = 0.0, LatenessSum = 0.0;
+	for (uint i = 0; i < HistoryCount; i++)
+	{
+		IntervalSum += Intervals[i];
+		IntervalSquares += double(Intervals[i]) * Intervals[i];
+		LatenessSum += Lateness[i];
+		Stats.MaxLatenessMs = std::max(Stats.MaxLatenessMs, Lateness[i]);
+	}
+	const double Mean = IntervalSum / HistoryCount;
+	Stats.MeanIntervalMs = float(Mean);
+	Stats.JitterMs = float(std::sqrt(std::max(IntervalSquares / HistoryCount - Mean * Mean, 0.0)));
+	Stats.MeanLatenessMs = float(LatenessSum / HistoryCount);
+	return Stats;
+}
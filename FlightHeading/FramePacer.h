@@ -0,0 +1,60 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+// Pacing over the last frames the pacer was active for; idle frames are left out
+struct PacingStats
+{
+	float TargetIntervalMs = 0.f;
+	float MeanIntervalMs = 0.f;
+	float JitterMs = 0.f;       // Standard deviation of the frame interval
+	float MeanLatenessMs = 0.f; // Frame start after its deadline
+	float MaxLatenessMs = 0.f;
+	uint Missed = 0;            // Frames more than an interval late, since Reset
+};
+
+// Starts frames at a fixed rate. Each wait sleeps until shortly before the deadline and spins the
+// rest, since a sleep can overshoot by a scheduler tick. Deadlines advance by the interval rather
+// than from when a frame ended, so one late frame does not delay every later one; a frame more than
+// an interval late resynchronizes instead of rushing to catch up. While idle the rate drops to
+// IdleHz and the wait polls WakeEarly, ending idle the moment it returns true.
+class FramePacer : public Useful::NonCopyable
+{
+public:
+	float TargetHz = 60.f; // 0 for no limit
+	float IdleHz = 5.f;
+	float SpinMs = 1.5f;   // Tail of every wait that is spun rather than slept
+
+	FramePacer();
+	~FramePacer();
+
+	void Reset();
+	void SetIdle(bool InIdle);
+	// Safe from any thread, so background pollers can slow down with the frames
+	inline bool IsIdle() const { return Idle; }
+
+	// Blocks until the next frame is due
+	void Wait(const std::function<bool()>& WakeEarly = nullptr);
+	PacingStats GetStats() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+	static constexpr uint HistorySize = 240;
+	static constexpr float WakeCheckMs = 4.f;
+
+	Clock::time_point Deadline;
+	Clock::time_point LastFrameStart;
+	bool Started = false;
+	std::atomic<bool> Idle{ false };
+	bool LastFrameIdle = false;
+	uint Missed = 0;
+	// Rings of the latest active frames, milliseconds
+	float Intervals[HistorySize] = {};
+	float Lateness[HistorySize] = {};
+	uint HistoryCount = 0;
+	uint HistoryNext = 0;
+
+	void RecordFrame(Clock::time_point Start);
+};
@@ -0,0 +1,165 @@
+#include "HeadingArbiter.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Layout of a packed result: 16-bit binary angle, flags, valid and miscompare masks, time in ms.
+	// Headings are already wrapped to [0, 360) here.
+	inline uint64_t Pack(float HeadingDegrees, uchar Flags, uchar ValidMask, uchar MiscompareMask, int64_t TimeUs)
+	{
+		const uint64_t Angle = uint64_t(HeadingDegrees * (65536.f / 360.f) + 0.5f) & 0xFFFF;
+		return Angle | (uint64_t(Flags) << 16) | (uint64_t(ValidMask & 0xF) << 24) | (uint64_t(MiscompareMask & 0xF) << 28)
+			| (uint64_t(uint32_t(TimeUs / 1000)) << 32);
+	}
+}
+
+HeadingArbiter::HeadingArbiter(uint InSourceCount, int64_t InStaleTimeoutUs, float InMiscompareDegrees, int64_t InMiscompareConfirmUs)
+	: SourceCount(std::min(std::max(InSourceCount, 1u), MaxSources)), StaleTimeoutUs(InStaleTimeoutUs),
+	MiscompareDegrees(InMiscompareDegrees), MiscompareConfirmUs(InMiscompareConfirmUs), Result(0)
+{
+	static_assert(MaxSources <= 4, "Masks are packed into 4 bits");
+	ASSERT(InSourceCount >= 1 && InSourceCount <= MaxSources);
+
+	for (std::atomic<uint64_t>& SourceResult : SourceResults)
+	{
+		SourceResult.store(0, std::memory_order_relaxed);
+	}
+}
+
+void HeadingArbiter::Submit(uint Source, int64_t TimeUs, float HeadingDegrees)
+{
+	if (Source >= SourceCount)
+	{
+		ASSERTNOENTRY("Unknown heading source!");
+		return;
+	}
+
+	SourceState& State = Sources[Source];
+	State.TimeUs = TimeUs;
+	State.HeadingDegrees = HeadingMath::Wrap360(HeadingDegrees);
+	State.HasSample = true;
+	Arbitrate(TimeUs);
+}
+
+void HeadingArbiter::Update(int64_t NowUs)
+{
+	Arbitrate(NowUs);
+}
+
+void HeadingArbiter::Arbitrate(int64_t NowUs)
+{
+	// Sources report on their own clocks' schedule, so never let arbitration time run backwards
+	LatestUs = std::max(LatestUs, NowUs);
+
+	uint Fresh[MaxSources];
+	float Offsets[MaxSources];
+	uint FreshCount = 0;
+	uchar ValidMask = 0;
+	int64_t NewestUs = 0;
+	float Reference = 0.f;
+
+	// Offsets are taken around the first fresh source, so voting never straddles north
+	for (uint Source = 0; Source < SourceCount; Source++)
+	{
+		SourceState& State = Sources[Source];
+		if (!State.HasSample || LatestUs - State.TimeUs > StaleTimeoutUs)
+		{
+			State.DisagreeSinceUs = -1;
+			continue;
+		}
+
+		if (FreshCount == 0)
+		{
+			Reference = State.HeadingDegrees;
+		}
+		Offsets[FreshCount] = HeadingMath::ShortestArc(Reference, State.HeadingDegrees);
+		Fresh[FreshCount++] = Source;
+		ValidMask |= uchar(1 << Source);
+		NewestUs = std::max(NewestUs, State.TimeUs);
+	}
+
+	uchar MiscompareMask = 0;
+	float Vote = 0.f;
+	if (FreshCount > 0)
+	{
+		// Insertion sort, there are at most MaxSources offsets
+		float Sorted[MaxSources];
+		for (uint i = 0; i < FreshCount; i++)
+		{
+			uint j = i;
+			for (; j > 0 && Sorted[j - 1] > Offsets[i]; j--)
+			{
+				Sorted[j] = Sorted[j - 1];
+			}
+			Sorted[j] = Offsets[i];
+		}
+		const float Median = FreshCount % 2 ? Sorted[FreshCount / 2] : 0.5f * (Sorted[FreshCount / 2 - 1] + Sorted[FreshCount / 2]);
+		Vote = HeadingMath::Wrap360(Reference + Median);
+
+		for (uint i = 0; i < FreshCount; i++)
+		{
+			SourceState& State = Sources[Fresh[i]];
+			if (std::fabs(Offsets[i] - Median) <= MiscompareDegrees)
+			{
+				State.DisagreeSinceUs = -1;
+				continue;
+			}
+
+			if (State.DisagreeSinceUs < 0)
+			{
+				State.DisagreeSinceUs = LatestUs;
+			}
+			if (LatestUs - State.DisagreeSinceUs >= MiscompareConfirmUs)
+			{
+				MiscompareMask |= uchar(1 << Fresh[i]);
+			}
+		}
+	}
+
+	uchar Flags = 0;
+	Flags |= FreshCount > 0 ? ArbitrationValid : 0;
+	Flags |= FreshCount < SourceCount ? ArbitrationDegraded : 0;
+	Flags |= MiscompareMask ? ArbitrationMiscompare : 0;
+	Result.store(Pack(Vote, Flags, ValidMask, MiscompareMask, FreshCount > 0 ? NewestUs : LatestUs), std::memory_order_release);
+
+	for (uint Source = 0; Source < SourceCount; Source++)
+	{
+		const SourceState& State = Sources[Source];
+		const uchar Bit = uchar(1 << Source);
+		uchar SourceFlags = 0;
+		SourceFlags |= (ValidMask & Bit) ? ArbitrationValid : 0;
+		SourceFlags |= (MiscompareMask & Bit) ? ArbitrationMiscompare : 0;
+		SourceResults[Source].store(Pack(State.HeadingDegrees, SourceFlags, ValidMask & Bit, MiscompareMask & Bit, State.TimeUs), std::memory_order_release);
+	}
+}
+
+ArbitratedHeading HeadingArbiter::Load(int64_t NowUs) const
+{
+	return Unpack(Result.load(std::memory_order_acquire), NowUs);
+}
+
+ArbitratedHeading HeadingArbiter::LoadSource(uint Source, int64_t NowUs) const
+{
+	ASSERT(Source < MaxSources);
+	return Unpack(SourceResults[Source].load(std::memory_order_acquire), NowUs);
+}
+
+ArbitratedHeading HeadingArbiter::Unpack(uint64_t Packed, int64_t NowUs) const
+{
+	ArbitratedHeading Out;
+	Out.HeadingDegrees = float(Packed & 0xFFFF) * (360.f / 65536.f);
+	Out.Flags = uchar(Packed >> 16);
+	Out.ValidMask = uchar((Packed >> 24) & 0xF);
+	Out.MiscompareMask = uchar((Packed >> 28) & 0xF);
+	Out.TimeMs = uint32_t(Packed >> 32);
+
+	// Wrap-safe in 32-bit milliseconds; catches a writer thread that stopped arbitrating altogether
+	const uint32_t AgeMs = uint32_t(NowUs / 1000) - Out.TimeMs;
+	if ((Out.Flags & ArbitrationValid) && int64_t(AgeMs) * 1000 > StaleTimeoutUs)
+	{
+		Out.Flags |= ArbitrationStale;
+	}
+	return Out;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <cstdint>
+
+enum ArbitrationFlags : uchar
+{
+	ArbitrationValid = 1 << 0,       // At least one fresh source contributed
+	ArbitrationDegraded = 1 << 1,    // Fewer fresh sources than configured
+	ArbitrationMiscompare = 1 << 2,  // A source disagreed with the vote for longer than the confirm time
+	ArbitrationStale = 1 << 3        // Set by the reader: the result itself has not been refreshed in time
+};
+
+// Arbitrated heading (or the state of one source) as seen by a reader
+struct ArbitratedHeading
+{
+	float HeadingDegrees = 0.f;
+	uchar Flags = 0;
+	uchar ValidMask = 0;        // Sources that were fresh, bit per source
+	uchar MiscompareMask = 0;   // Sources flagged as disagreeing
+	uint32_t TimeMs = 0;        // Newest contributing sample, HeadingFeed::NowUs() / 1000 truncated to 32 bits
+
+	inline bool IsUsable() const { return (Flags & ArbitrationValid) && !(Flags & ArbitrationStale); }
+};
+
+// Picks or votes a heading out of up to MaxSources redundant sources. Samples are timestamped and
+// a source counts only while its newest sample is younger than the stale timeout. Three or more
+// fresh sources are median voted, two are averaged, one is passed through as degraded. A source
+// further than the miscompare threshold from the vote for longer than the confirm time is flagged.
+//
+// Submit and Update belong to one writer thread and cost O(MaxSources) whatever the sample rate.
+// Every result is packed into one 64-bit word, so Load on the render thread is a single atomic load.
+class HeadingArbiter : public Useful::NonCopyable
+{
+public:
+	static constexpr uint MaxSources = 4;
+
+	explicit HeadingArbiter(uint InSourceCount, int64_t InStaleTimeoutUs = 250000, float InMiscompareDegrees = 6.f, int64_t InMiscompareConfirmUs = 1000000);
+
+	// Writer side
+	void Submit(uint Source, int64_t TimeUs, float HeadingDegrees);
+	// Re-arbitrates without a new sample so that sources that went quiet time out
+	void Update(int64_t NowUs);
+
+	// Reader side, wait-free from any thread
+	ArbitratedHeading Load(int64_t NowUs) const;
+	ArbitratedHeading LoadSource(uint Source, int64_t NowUs) const;
+
+	inline uint GetSourceCount() const { return SourceCount; }
+
+private:
+	struct SourceState
+	{
+		int64_t TimeUs = 0;
+		float HeadingDegrees = 0.f;
+		bool HasSample = false;
+		int64_t DisagreeSinceUs = -1;  // -1 while agreeing with the vote
+	};
+
+	const uint SourceCount;
+	const int64_t StaleTimeoutUs;
+	const float MiscompareDegrees;
+	const int64_t MiscompareConfirmUs;
+	SourceState Sources[MaxSources];
+	int64_t LatestUs = 0;
+
+	std::atomic<uint64_t> Result;
+	std::atomic<uint64_t> SourceResults[MaxSources];
+
+	void Arbitrate(int64_t NowUs);
+	ArbitratedHeading Unpack(uint64_t Packed, int64_t NowUs) const;
+};
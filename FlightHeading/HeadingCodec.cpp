@@ -0,0 +1,478 @@
+#include "HeadingCodec.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+	// Per block: TimeBytes, AngleBytes, FirstTime, FirstAngle, Count
+	constexpr size_t BlockHeaderSize = sizeof(uint32_t) * 2 + sizeof(int64_t) + sizeof(uint16_t) + sizeof(uint32_t);
+
+	constexpr uint32_t LogMagic = 0x474C4846; // "FHLG"
+	constexpr uint32_t LogVersion = 1;
+
+	struct LogFooter
+	{
+		uint64_t IndexOffset;
+		uint64_t BlockCount;
+		uint32_t Magic;
+		uint32_t Version;
+	};
+
+	struct BitReader
+	{
+		const uchar* Data;
+		size_t Size;
+		size_t BytePos = 0;
+		uint64_t Acc = 0;
+		uint BitCount = 0;
+
+		BitReader(const uchar* InData, size_t InSize) : Data(InData), Size(InSize) {}
+
+		inline void Refill()
+		{
+			if (BytePos + 8 <= Size)
+			{
+				uint64_t Word;
+				std::memcpy(&Word, Data + BytePos, sizeof(Word));
+				Acc |= Word << BitCount;
+				const uint Taken = (63 - BitCount) >> 3;
+				BytePos += Taken;
+				BitCount += Taken * 8;
+				return;
+			}
+
+			while (BitCount <= 56)
+			{
+				const uint64_t Byte = BytePos < Size ? Data[BytePos] : 0;
+				BytePos++;
+				Acc |= Byte << BitCount;
+				BitCount += 8;
+			}
+		}
+
+		// Bits <= 32, callers refill up front for a whole code
+		inline uint64_t Read(uint Bits)
+		{
+			const uint64_t Value = Acc & ((uint64_t(1) << Bits) - 1);
+			Acc >>= Bits;
+			BitCount -= Bits;
+			return Value;
+		}
+	};
+
+	inline uint64_t ZigZag64(int64_t Value) { return (uint64_t(Value) << 1) ^ uint64_t(Value >> 63); }
+	inline int64_t UnZigZag64(uint64_t Value) { return int64_t(Value >> 1) ^ -int64_t(Value & 1); }
+	inline uint16_t ZigZag16(int16_t Value) { return uint16_t((uint16_t(Value) << 1) ^ uint16_t(Value >> 15)); }
+	inline int16_t UnZigZag16(uint16_t Value) { return int16_t((Value >> 1) ^ uint16_t(-int16_t(Value & 1))); }
+
+	// Prefix codes, least significant bit first:
+	// time  dod: 0 | 01 +7 | 011 +9 | 0111 +12 | 1111 +32
+	// angle dod: 0 | 01 +4 | 011 +8 | 111 +16
+	inline int64_t ReadTimeCode(BitReader& Reader)
+	{
+		if (Reader.BitCount < 36)
+		{
+			Reader.Refill();
+		}
+
+		if ((Reader.Acc & 1) == 0)
+		{
+			Reader.Read(1);
+			return 0;
+		}
+		if ((Reader.Acc & 2) == 0)
+		{
+			Reader.Read(2);
+			return UnZigZag64(Reader.Read(7));
+		}
+		if ((Reader.Acc & 4) == 0)
+		{
+			Reader.Read(3);
+			return UnZigZag64(Reader.Read(9));
+		}
+		const bool Wide = (Reader.Acc & 8) != 0;
+		Reader.Read(4);
+		return UnZigZag64(Reader.Read(Wide ? 32 : 12));
+	}
+
+	inline int16_t ReadAngleCode(BitReader& Reader)
+	{
+		if (Reader.BitCount < 19)
+		{
+			Reader.Refill();
+		}
+
+		if ((Reader.Acc & 1) == 0)
+		{
+			Reader.Read(1);
+			return 0;
+		}
+		if ((Reader.Acc & 2) == 0)
+		{
+			Reader.Read(2);
+			return UnZigZag16(uint16_t(Reader.Read(4)));
+		}
+		const bool Wide = (Reader.Acc & 4) != 0;
+		Reader.Read(3);
+		return UnZigZag16(uint16_t(Reader.Read(Wide ? 16 : 8)));
+	}
+}
+
+// Begin- HeadingEncoder
+void HeadingEncoder::BitWriter::Write(uint64_t Value, uint Bits)
+{
+	Acc |= Value << BitCount;
+	BitCount += Bits;
+	while (BitCount >= 8)
+	{
+		Bytes.push_back(uchar(Acc));
+		Acc >>= 8;
+		BitCount -= 8;
+	}
+}
+
+void HeadingEncoder::BitWriter::Finish()
+{
+	if (BitCount > 0)
+	{
+		Bytes.push_back(uchar(Acc));
+	}
+	Acc = 0;
+	BitCount = 0;
+}
+
+void HeadingEncoder::BitWriter::Reset()
+{
+	Bytes.clear();
+	Acc = 0;
+	BitCount = 0;
+}
+
+HeadingEncoder::HeadingEncoder(HeadingSeries& InSeries, uint InBlockSize)
+	: Series(InSeries), BlockSize(std::max(InBlockSize, 2u))
+{
+}
+
+HeadingEncoder::~HeadingEncoder()
+{
+	Flush();
+}
+
+void HeadingEncoder::Append(int64_t TimeUs, float HeadingDegrees)
+{
+	const uint16_t Angle = HeadingDecoder::QuantizeHeading(HeadingDegrees);
+
+	if (BlockCount == 0)
+	{
+		FirstTime = PrevTime = TimeUs;
+		FirstAngle = PrevAngle = Angle;
+		PrevTimeDelta = 0;
+		PrevAngleDelta = 0;
+		BlockCount = 1;
+		Series.SampleCount++;
+		return;
+	}
+
+	const int64_t TimeDelta = TimeUs - PrevTime;
+	const int64_t TimeDod = TimeDelta - PrevTimeDelta;
+	if (TimeDelta < 0 || TimeDod > std::numeric_limits<int32_t>::max() || TimeDod < std::numeric_limits<int32_t>::min())
+	{
+		// Out of order or a gap too long for the widest code, start over in a fresh block
+		ASSERT(TimeDelta >= 0);
+		Flush();
+		Append(TimeUs, HeadingDegrees);
+		return;
+	}
+
+	const uint64_t TimeCode = ZigZag64(TimeDod);
+	if (TimeCode == 0)
+	{
+		TimeBits.Write(0, 1);
+	}
+	else if (TimeCode < (1u << 7))
+	{
+		TimeBits.Write(0x1 | (TimeCode << 2), 2 + 7);
+	}
+	else if (TimeCode < (1u << 9))
+	{
+		TimeBits.Write(0x3 | (TimeCode << 3), 3 + 9);
+	}
+	else if (TimeCode < (1u << 12))
+	{
+		TimeBits.Write(0x7 | (TimeCode << 4), 4 + 12);
+	}
+	else
+	{
+		TimeBits.Write(0xF | (TimeCode << 4), 4 + 32);
+	}
+
+	// Modular 16-bit arithmetic makes the delta take the short way across north
+	const int16_t AngleDelta = int16_t(uint16_t(Angle - PrevAngle));
+	const uint16_t AngleCode = ZigZag16(int16_t(uint16_t(AngleDelta - PrevAngleDelta)));
+	if (AngleCode == 0)
+	{
+		AngleBits.Write(0, 1);
+	}
+	else if (AngleCode < (1u << 4))
+	{
+		AngleBits.Write(0x1 | (uint64_t(AngleCode) << 2), 2 + 4);
+	}
+	else if (AngleCode < (1u << 8))
+	{
+		AngleBits.Write(0x3 | (uint64_t(AngleCode) << 3), 3 + 8);
+	}
+	else
+	{
+		AngleBits.Write(0x7 | (uint64_t(AngleCode) << 3), 3 + 16);
+	}
+
+	PrevTime = TimeUs;
+	PrevTimeDelta = TimeDelta;
+	PrevAngle = Angle;
+	PrevAngleDelta = AngleDelta;
+	Series.SampleCount++;
+
+	if (++BlockCount == BlockSize)
+	{
+		Flush();
+	}
+}
+
+void HeadingEncoder::Flush()
+{
+	if (BlockCount == 0)
+	{
+		return;
+	}
+
+	TimeBits.Finish();
+	AngleBits.Finish();
+
+	const uint32_t TimeBytes = uint32_t(TimeBits.Bytes.size());
+	const uint32_t AngleBytes = uint32_t(AngleBits.Bytes.size());
+	const uint32_t Count = BlockCount;
+
+	Series.Blocks.push_back({ FirstTime, Series.Bytes.size(), BlockCount });
+
+	const size_t Offset = Series.Bytes.size();
+	Series.Bytes.resize(Offset + BlockHeaderSize + TimeBytes + AngleBytes);
+	uchar* Out = Series.Bytes.data() + Offset;
+	std::memcpy(Out, &TimeBytes, sizeof(TimeBytes)); Out += sizeof(TimeBytes);
+	std::memcpy(Out, &AngleBytes, sizeof(AngleBytes)); Out += sizeof(AngleBytes);
+	std::memcpy(Out, &FirstTime, sizeof(FirstTime)); Out += sizeof(FirstTime);
+	std::memcpy(Out, &FirstAngle, sizeof(FirstAngle)); Out += sizeof(FirstAngle);
+	std::memcpy(Out, &Count, sizeof(Count)); Out += sizeof(Count);
+	std::memcpy(Out, TimeBits.Bytes.data(), TimeBytes); Out += TimeBytes;
+	std::memcpy(Out, AngleBits.Bytes.data(), AngleBytes);
+
+	TimeBits.Reset();
+	AngleBits.Reset();
+	BlockCount = 0;
+}
+// End- HeadingEncoder
+
+// Begin- HeadingDecoder
+HeadingDecoder::HeadingDecoder(const HeadingSeries& InSeries)
+	: Series(InSeries)
+{
+}
+
+bool HeadingDecoder::Seek(int64_t TimeUs)
+{
+	if (Series.Blocks.empty())
+	{
+		return false;
+	}
+
+	auto It = std::upper_bound(Series.Blocks.begin(), Series.Blocks.end(), TimeUs,
+		[](int64_t Time, const HeadingBlockInfo& Block) { return Time < Block.FirstTime; });
+	const uint BlockIndex = It == Series.Blocks.begin() ? 0 : uint(It - Series.Blocks.begin()) - 1;
+
+	LoadBlock(BlockIndex);
+	CurrentSample = uint(std::lower_bound(BlockTimes.begin(), BlockTimes.end(), TimeUs) - BlockTimes.begin());
+
+	if (CurrentSample == BlockTimes.size())
+	{
+		if (CurrentBlock + 1 >= Series.Blocks.size())
+		{
+			return false;
+		}
+		LoadBlock(CurrentBlock + 1);
+	}
+	return true;
+}
+
+bool HeadingDecoder::Next(int64_t& OutTimeUs, float& OutHeadingDegrees)
+{
+	if (!BlockLoaded)
+	{
+		if (Series.Blocks.empty())
+		{
+			return false;
+		}
+		LoadBlock(0);
+	}
+
+	while (CurrentSample >= BlockTimes.size())
+	{
+		if (CurrentBlock + 1 >= Series.Blocks.size())
+		{
+			return false;
+		}
+		LoadBlock(CurrentBlock + 1);
+	}
+
+	OutTimeUs = BlockTimes[CurrentSample];
+	OutHeadingDegrees = BlockHeadings[CurrentSample];
+	CurrentSample++;
+	return true;
+}
+
+void HeadingDecoder::DecodeBlock(const HeadingSeries& Series, uint BlockIndex, int64_t* OutTimesUs, float* OutHeadings)
+{
+	DecodeBlock(Series.Bytes.data() + Series.Blocks[BlockIndex].ByteOffset, OutTimesUs, OutHeadings);
+}
+
+uint HeadingDecoder::DecodeBlock(const uchar* BlockData, int64_t* OutTimesUs, float* OutHeadings)
+{
+	const uchar* In = BlockData;
+
+	uint32_t TimeBytes, AngleBytes, Count;
+	int64_t Time;
+	uint16_t Angle;
+	std::memcpy(&TimeBytes, In, sizeof(TimeBytes)); In += sizeof(TimeBytes);
+	std::memcpy(&AngleBytes, In, sizeof(AngleBytes)); In += sizeof(AngleBytes);
+	std::memcpy(&Time, In, sizeof(Time)); In += sizeof(Time);
+	std::memcpy(&Angle, In, sizeof(Angle)); In += sizeof(Angle);
+	std::memcpy(&Count, In, sizeof(Count)); In += sizeof(Count);
+
+	BitReader TimeReader(In, TimeBytes);
+	BitReader AngleReader(In + TimeBytes, AngleBytes);
+
+	OutTimesUs[0] = Time;
+	int64_t TimeDelta = 0;
+	for (uint32_t i = 1; i < Count; i++)
+	{
+		TimeDelta += ReadTimeCode(TimeReader);
+		Time += TimeDelta;
+		OutTimesUs[i] = Time;
+	}
+
+	OutHeadings[0] = DequantizeHeading(Angle);
+	int16_t AngleDelta = 0;
+	for (uint32_t i = 1; i < Count; i++)
+	{
+		AngleDelta = int16_t(uint16_t(AngleDelta + ReadAngleCode(AngleReader)));
+		Angle = uint16_t(Angle + AngleDelta);
+		OutHeadings[i] = DequantizeHeading(Angle);
+	}
+
+	return Count;
+}
+
+uint16_t HeadingDecoder::QuantizeHeading(float HeadingDegrees)
+{
+	const float Scaled = HeadingMath::Wrap360(HeadingDegrees) * (65536.f / 360.f);
+	return uint16_t(uint32_t(Scaled + 0.5f) & 0xFFFF);
+}
+
+float HeadingDecoder::DequantizeHeading(uint16_t Angle)
+{
+	return Angle * (360.f / 65536.f);
+}
+
+void HeadingDecoder::LoadBlock(uint BlockIndex)
+{
+	const uint Count = Series.Blocks[BlockIndex].Count;
+	BlockTimes.resize(Count);
+	BlockHeadings.resize(Count);
+	DecodeBlock(Series, BlockIndex, BlockTimes.data(), BlockHeadings.data());
+
+	CurrentBlock = BlockIndex;
+	CurrentSample = 0;
+	BlockLoaded = true;
+}
+// End- HeadingDecoder
+
+// Begin- Heading log files
+bool SaveHeadingLog(const std::string& Path, const HeadingSeries& Series)
+{
+	std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		std::cout << "Could not write heading log: " << Path << std::endl;
+		return false;
+	}
+
+	const uint32_t Header[2] = { LogMagic, LogVersion };
+	Stream.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+	Stream.write(reinterpret_cast<const char*>(Series.Bytes.data()), Series.Bytes.size());
+
+	for (const HeadingBlockInfo& Block : Series.Blocks)
+	{
+		HeadingBlockInfo FileBlock = Block;
+		FileBlock.ByteOffset += sizeof(Header);
+		Stream.write(reinterpret_cast<const char*>(&FileBlock), sizeof(FileBlock));
+	}
+
+	const LogFooter Footer = { sizeof(Header) + Series.Bytes.size(), Series.Blocks.size(), LogMagic, LogVersion };
+	Stream.write(reinterpret_cast<const char*>(&Footer), sizeof(Footer));
+	return Stream.good();
+}
+
+bool ReadHeadingLogIndex(const uchar* Data, size_t Size, std::vector<HeadingBlockInfo>& OutBlocks)
+{
+	OutBlocks.clear();
+
+	uint32_t Header[2];
+	LogFooter Footer;
+	if (Size < sizeof(Header) + sizeof(Footer))
+	{
+		return false;
+	}
+	std::memcpy(Header, Data, sizeof(Header));
+	std::memcpy(&Footer, Data + Size - sizeof(Footer), sizeof(Footer));
+
+	if (Footer.BlockCount > Size / sizeof(HeadingBlockInfo))
+	{
+		return false;
+	}
+	const uint64_t IndexBytes = Footer.BlockCount * sizeof(HeadingBlockInfo);
+	if (Header[0] != LogMagic || Footer.Magic != LogMagic || Header[1] != LogVersion || Footer.Version != LogVersion
+		|| Footer.IndexOffset < sizeof(Header) || Footer.IndexOffset + IndexBytes + sizeof(Footer) != Size)
+	{
+		return false;
+	}
+
+	OutBlocks.resize(Footer.BlockCount);
+	std::memcpy(OutBlocks.data(), Data + Footer.IndexOffset, IndexBytes);
+
+	// Decoding trusts the block headers, and callers size their buffers from the index, so every
+	// block has to agree with its index entry and end before the next block starts
+	for (size_t i = 0; i < OutBlocks.size(); i++)
+	{
+		const HeadingBlockInfo& Block = OutBlocks[i];
+		const uint64_t End = i + 1 < OutBlocks.size() ? OutBlocks[i + 1].ByteOffset : Footer.IndexOffset;
+		if (Block.ByteOffset < sizeof(Header) || Block.ByteOffset > End || End - Block.ByteOffset < BlockHeaderSize)
+		{
+			OutBlocks.clear();
+			return false;
+		}
+
+		uint32_t TimeBytes, AngleBytes, Count;
+		const uchar* BlockHeader = Data + Block.ByteOffset;
+		std::memcpy(&TimeBytes, BlockHeader, sizeof(TimeBytes));
+		std::memcpy(&AngleBytes, BlockHeader + sizeof(TimeBytes), sizeof(AngleBytes));
+		std::memcpy(&Count, BlockHeader + BlockHeaderSize - sizeof(Count), sizeof(Count));
+		if (Count == 0 || Count != Block.Count || BlockHeaderSize + uint64_t(TimeBytes) + AngleBytes > End - Block.ByteOffset)
+		{
+			OutBlocks.clear();
+			return false;
+		}
+	}
+	return true;
+}
+// End- Heading log files
@@ -0,0 +1,100 @@
+#pragma once
+#include "Core.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Columnar, block-based compression for (timestamp, heading) samples.
+//
+// Timestamps are integer microseconds stored as Gorilla-style delta-of-delta codes. Headings are
+// quantized to 16-bit binary angles (360 / 65536 = 0.0055 degree steps), so deltas wrap across
+// 359 -> 0 for free in modular arithmetic; the delta-of-delta is zigzagged and written with a
+// short prefix code. Each block stores its time column and angle column back to back, and a
+// block index keeps the first timestamp and byte offset of every block for seeking.
+struct HeadingBlockInfo
+{
+	int64_t FirstTime;
+	uint64_t ByteOffset;
+	uint Count;
+};
+
+struct HeadingSeries
+{
+	std::vector<uchar> Bytes;
+	std::vector<HeadingBlockInfo> Blocks;
+	uint64_t SampleCount = 0;
+
+	inline size_t GetEncodedSize() const { return Bytes.size() + Blocks.size() * sizeof(HeadingBlockInfo); }
+};
+
+// Streaming encoder the ingest path appends to. Samples must have non-decreasing timestamps.
+class HeadingEncoder
+{
+public:
+	explicit HeadingEncoder(HeadingSeries& InSeries, uint InBlockSize = 1024);
+	~HeadingEncoder();
+
+	void Append(int64_t TimeUs, float HeadingDegrees);
+	// Writes the partially filled block. Appending afterwards starts a new block.
+	void Flush();
+
+private:
+	struct BitWriter
+	{
+		std::vector<uchar> Bytes;
+		uint64_t Acc = 0;
+		uint BitCount = 0;
+
+		void Write(uint64_t Value, uint Bits);
+		void Finish();
+		void Reset();
+	};
+
+	HeadingSeries& Series;
+	uint BlockSize;
+	uint BlockCount = 0;
+	int64_t FirstTime = 0;
+	uint16_t FirstAngle = 0;
+	int64_t PrevTime = 0;
+	int64_t PrevTimeDelta = 0;
+	uint16_t PrevAngle = 0;
+	int16_t PrevAngleDelta = 0;
+	BitWriter TimeBits;
+	BitWriter AngleBits;
+};
+
+class HeadingDecoder
+{
+public:
+	explicit HeadingDecoder(const HeadingSeries& InSeries);
+
+	// Positions the decoder on the first sample with a timestamp >= TimeUs. Returns false past the end.
+	bool Seek(int64_t TimeUs);
+	bool Next(int64_t& OutTimeUs, float& OutHeadingDegrees);
+
+	// Bulk decode of one block into caller arrays of at least Blocks[BlockIndex].Count entries
+	static void DecodeBlock(const HeadingSeries& Series, uint BlockIndex, int64_t* OutTimesUs, float* OutHeadings);
+	// Same, straight from encoded block bytes (e.g. a mapped log file). Returns the sample count.
+	static uint DecodeBlock(const uchar* BlockData, int64_t* OutTimesUs, float* OutHeadings);
+
+	static uint16_t QuantizeHeading(float HeadingDegrees);
+	static float DequantizeHeading(uint16_t Angle);
+
+private:
+	const HeadingSeries& Series;
+	std::vector<int64_t> BlockTimes;
+	std::vector<float> BlockHeadings;
+	uint CurrentBlock = 0;
+	uint CurrentSample = 0;
+	bool BlockLoaded = false;
+
+	void LoadBlock(uint BlockIndex);
+};
+
+// Heading log files: a small header, the encoded blocks as written by HeadingEncoder, then the
+// block index and a footer pointing at it, so readers can find every block without touching them.
+bool SaveHeadingLog(const std::string& Path, const HeadingSeries& Series);
+// Reads the block index of a log held in memory. Offsets are relative to Data. False unless every
+// block's header matches its index entry and fits before the next block, so decoding the blocks
+// into buffers sized from the index is safe.
+bool ReadHeadingLogIndex(const uchar* Data, size_t Size, std::vector<HeadingBlockInfo>& OutBlocks);
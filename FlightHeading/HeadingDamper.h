@@ -0,0 +1,51 @@
+#pragma once
+#include "HeadingMath.h"
+#include <cmath>
+
+// Critically damped follower for a displayed heading (compass card, needle). Steps the exact solution
+// of the spring, so the motion is the same at any frame rate, and works on the shortest arc so it never
+// spins the long way round across north.
+class HeadingDamper
+{
+public:
+	// Roughly the time to close most of a step change, in seconds
+	explicit HeadingDamper(float InSmoothTime = 0.15f) : SmoothTime(InSmoothTime) {}
+
+	// Jumps straight to Heading and stops
+	inline void Reset(float HeadingDegrees)
+	{
+		Heading = HeadingMath::Wrap360(HeadingDegrees);
+		Velocity = 0.f;
+	}
+
+	inline float Update(float TargetDegrees, float DeltaSeconds)
+	{
+		if (SmoothTime <= 0.f)
+		{
+			Reset(TargetDegrees);
+			return Heading;
+		}
+		if (DeltaSeconds <= 0.f)
+		{
+			return Heading;
+		}
+
+		const float Omega = 2.f / SmoothTime;
+		const float Offset = HeadingMath::ShortestArc(TargetDegrees, Heading);
+		const float Decay = std::exp(-Omega * DeltaSeconds);
+		const float Temp = (Velocity + Omega * Offset) * DeltaSeconds;
+		Velocity = (Velocity - Omega * Temp) * Decay;
+		Heading = HeadingMath::Wrap360(TargetDegrees + (Offset + Temp) * Decay);
+		return Heading;
+	}
+
+	inline float GetHeading() const { return Heading; }
+	// Degrees per second, positive clockwise
+	inline float GetVelocity() const { return Velocity; }
+
+	float SmoothTime;
+
+private:
+	float Heading = 0.f;
+	float Velocity = 0.f;
+};
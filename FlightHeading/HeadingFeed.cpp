@@ -0,0 +1,205 @@
+#include "HeadingFeed.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	constexpr uint32_t FeedMagic = 0x46484644; // "FHFD"
+	constexpr uint32_t FeedVersion = 3;
+	constexpr uint PayloadWords = 3;
+	constexpr uint ReadAttempts = 4;
+
+	static_assert(sizeof(HeadingFeedSample) == PayloadWords * sizeof(uint64_t), "Payload layout changed");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory atomics must be lock free");
+
+	// Payload words are atomics so that the torn reads a seqlock tolerates are not data races
+	struct FeedSlot
+	{
+		alignas(64) std::atomic<uint32_t> Sequence; // Odd while a write is in progress
+		std::atomic<uint64_t> Payload[PayloadWords];
+	};
+
+	struct FeedBlock
+	{
+		std::atomic<uint32_t> Magic;
+		uint32_t Version;
+		std::atomic<uint32_t> Writers; // Open HeadingFeedWriters, in any process
+		FeedSlot Slots[HeadingFeed::MaxSources];
+	};
+
+	inline FeedBlock* GetBlock(const SharedMemory& Segment)
+	{
+		return static_cast<FeedBlock*>(Segment.GetData());
+	}
+}
+
+int64_t HeadingFeed::NowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Begin- HeadingFeedWriter
+HeadingFeedWriter::~HeadingFeedWriter()
+{
+	Close();
+}
+
+bool HeadingFeedWriter::Create(const std::string& Name)
+{
+	Close();
+	if (!Segment.Create(Name, sizeof(FeedBlock)))
+	{
+		return false;
+	}
+	FeedName = Name;
+
+	// New segments are zero filled, so every slot starts with an even sequence. A restarted
+	// publisher keeps the existing sequences so connected readers carry on.
+	FeedBlock* Block = GetBlock(Segment);
+	const uint32_t Magic = Block->Magic.load(std::memory_order_acquire);
+	if (Magic == FeedMagic && Block->Version == FeedVersion)
+	{
+		Block->Writers.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// A block left by a publisher of another version has slots in another layout, and readers would
+	// refuse it for good. It is cleared and taken over; new readers open it once Magic is set.
+	Block->Magic.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (FeedSlot& Slot : Block->Slots)
+	{
+		Slot.Sequence.store(0, std::memory_order_relaxed);
+		for (std::atomic<uint64_t>& Word : Slot.Payload)
+		{
+			Word.store(0, std::memory_order_relaxed);
+		}
+	}
+	Block->Version = FeedVersion;
+	Block->Writers.store(1, std::memory_order_relaxed);
+	Block->Magic.store(FeedMagic, std::memory_order_release);
+	return true;
+}
+
+void HeadingFeedWriter::Close()
+{
+	if (!Segment.IsOpen())
+	{
+		return;
+	}
+
+	// A writer that crashed never gets here, so its feed stays until Remove or a reboot
+	const bool Last = GetBlock(Segment)->Writers.fetch_sub(1, std::memory_order_acq_rel) == 1;
+	Segment.Close();
+	if (Last)
+	{
+		SharedMemory::Remove(FeedName);
+	}
+}
+
+bool HeadingFeedWriter::Remove(const std::string& Name)
+{
+	return SharedMemory::Remove(Name);
+}
+
+void HeadingFeedWriter::Publish(const HeadingFeedSample& Sample)
+{
+	if (!Segment.IsOpen() || Sample.SourceID >= HeadingFeed::MaxSources)
+	{
+		ASSERT(Sample.SourceID < HeadingFeed::MaxSources);
+		return;
+	}
+
+	uint64_t Words[PayloadWords];
+	std::memcpy(Words, &Sample, sizeof(Words));
+
+	FeedSlot& Slot = GetBlock(Segment)->Slots[Sample.SourceID];
+	uint32_t Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+	Sequence += Sequence & 1; // The previous publisher of this slot died mid-write
+	Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (uint i = 0; i < PayloadWords; i++)
+	{
+		Slot.Payload[i].store(Words[i], std::memory_order_relaxed);
+	}
+	Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+}
+// End- HeadingFeedWriter
+
+// Begin- HeadingFeedReader
+bool HeadingFeedReader::Open(const std::string& Name)
+{
+	if (!Segment.Open(Name, sizeof(FeedBlock)))
+	{
+		return false;
+	}
+
+	const FeedBlock* Block = GetBlock(Segment);
+	if (Block->Magic.load(std::memory_order_acquire) != FeedMagic || Block->Version != FeedVersion)
+	{
+		Segment.Close();
+		return false;
+	}
+
+	// Whatever is already in the block counts as new, so a late reader starts with the current state
+	for (uint Source = 0; Source < HeadingFeed::MaxSources; Source++)
+	{
+		LastSequence[Source] = 0;
+		Missed[Source] = 0;
+	}
+	return true;
+}
+
+void HeadingFeedReader::Close()
+{
+	Segment.Close();
+}
+
+bool HeadingFeedReader::Read(uint Source, HeadingFeedSample& OutSample)
+{
+	if (!Segment.IsOpen() || Source >= HeadingFeed::MaxSources)
+	{
+		return false;
+	}
+
+	const FeedSlot& Slot = GetBlock(Segment)->Slots[Source];
+	for (uint Attempt = 0; Attempt < ReadAttempts; Attempt++)
+	{
+		const uint32_t Before = Slot.Sequence.load(std::memory_order_acquire);
+		if (Before == LastSequence[Source])
+		{
+			return false;
+		}
+		if (Before & 1)
+		{
+			continue;
+		}
+
+		uint64_t Words[PayloadWords];
+		for (uint i = 0; i < PayloadWords; i++)
+		{
+			Words[i] = Slot.Payload[i].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (Slot.Sequence.load(std::memory_order_relaxed) != Before)
+		{
+			continue;
+		}
+
+		if (LastSequence[Source] != 0)
+		{
+			Missed[Source] += (Before - LastSequence[Source]) / 2 - 1;
+		}
+		LastSequence[Source] = Before;
+		std::memcpy(&OutSample, Words, sizeof(Words));
+		return true;
+	}
+	return false;
+}
+
+bool HeadingFeedReader::HasWriters() const
+{
+	return Segment.IsOpen() && GetBlock(Segment)->Writers.load(std::memory_order_relaxed) > 0;
+}
+// End- HeadingFeedReader
@@ -0,0 +1,72 @@
+#pragma once
+#include "Core.h"
+#include "SharedMemory.h"
+#include <cstdint>
+#include <string>
+
+// Latest heading state published by a co-located simulator
+struct HeadingFeedSample
+{
+	int64_t TimeUs = 0;         // HeadingFeed::NowUs() of the publisher
+	float HeadingDegrees = 0.f;
+	float RateOfTurn = 0.f;     // Degrees per second, 0 when unknown
+	uint32_t SourceID = 0;      // Slot the sample is published in, below HeadingFeed::MaxSources
+	uint32_t Flags = 0;
+};
+
+// Heading feed in shared memory with one slot per heading source (AHRS 1/2, standby, ...). Every
+// slot has a single writer and any number of readers, and is protected by a seqlock: the writer
+// bumps the sequence to odd, stores the payload and bumps it back to even, and readers retry when
+// the sequence moved under them. Neither side blocks or makes a syscall once the segment is mapped.
+namespace HeadingFeed
+{
+	constexpr const char* DefaultName = "FlightHeading.HeadingFeed";
+	constexpr uint MaxSources = 4;
+
+	// Monotonic microseconds, comparable across processes on the same host
+	int64_t NowUs();
+}
+
+class HeadingFeedWriter : public Useful::NonCopyable
+{
+public:
+	~HeadingFeedWriter();
+
+	bool Create(const std::string& Name = HeadingFeed::DefaultName);
+	// The last writer to close removes the feed, so readers started later do not open a dead one
+	void Close();
+	inline bool IsOpen() const { return Segment.IsOpen(); }
+	// Removes the feed whatever writers still have it open, e.g. one left by a crashed publisher
+	static bool Remove(const std::string& Name = HeadingFeed::DefaultName);
+
+	// Publishes into the slot of Sample.SourceID. Only one process may publish into a slot at a time.
+	void Publish(const HeadingFeedSample& Sample);
+
+private:
+	SharedMemory Segment;
+	std::string FeedName;
+};
+
+class HeadingFeedReader : public Useful::NonCopyable
+{
+public:
+	// Fails while no publisher has created the feed yet
+	bool Open(const std::string& Name = HeadingFeed::DefaultName);
+	void Close();
+	inline bool IsOpen() const { return Segment.IsOpen(); }
+
+	// Copies the latest sample of Source into OutSample. Returns false when nothing new was published
+	// since the previous call or a write is in progress; OutSample is left untouched then.
+	bool Read(uint Source, HeadingFeedSample& OutSample);
+	// False once the last writer has closed the feed. A publisher started after that creates a new
+	// feed, which needs another Open.
+	bool HasWriters() const;
+
+	// Samples of Source that were overwritten before being seen
+	inline uint64_t GetMissedCount(uint Source) const { return Missed[Source]; }
+
+private:
+	SharedMemory Segment;
+	uint32_t LastSequence[HeadingFeed::MaxSources] = {};
+	uint64_t Missed[HeadingFeed::MaxSources] = {};
+};
@@ -0,0 +1,188 @@
+#include "HeadingHistory.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Begin- TimeSeriesPyramid
+TimeSeriesPyramid::TimeSeriesPyramid(double InBaseInterval, uint InLevelFactor, uint InLevelCount, uint InCapacity)
+{
+	ASSERT(InBaseInterval > 0.0 && InLevelFactor > 1 && InLevelCount > 0 && InCapacity > 0);
+
+	Levels.resize(InLevelCount);
+	double Interval = InBaseInterval;
+	for (Level& Lv : Levels)
+	{
+		Lv.Interval = Interval;
+		Lv.Ring.resize(InCapacity);
+		Interval *= InLevelFactor;
+	}
+}
+
+void TimeSeriesPyramid::Push(double Time, float Value)
+{
+	Accumulate(0, Time, Value, Value, Value, 1);
+}
+
+void TimeSeriesPyramid::Clear()
+{
+	for (Level& Lv : Levels)
+	{
+		Lv.Head = 0;
+		Lv.Size = 0;
+		Lv.Pending.Count = 0;
+		Lv.PendingSum = 0.0;
+	}
+}
+
+uint TimeSeriesPyramid::Query(double Start, double End, uint MaxPoints, std::vector<SeriesBucket>& OutBuckets) const
+{
+	OutBuckets.clear();
+	if (End < Start)
+	{
+		return 0;
+	}
+
+	auto OldestTime = [this](uint LevelIndex)
+	{
+		const Level& Lv = Levels[LevelIndex];
+		if (Lv.Size > 0)
+		{
+			return Lv.At(0).Time;
+		}
+		return Lv.Pending.Count > 0 ? Lv.Pending.Time : std::numeric_limits<double>::max();
+	};
+
+	const uint LevelCount = GetLevelCount();
+	uint Chosen = LevelCount - 1;
+	for (uint L = 0; L < LevelCount; L++)
+	{
+		if ((End - Start) / Levels[L].Interval <= MaxPoints)
+		{
+			Chosen = L;
+			break;
+		}
+	}
+
+	// A finer level may already have dropped the start of the window, go coarser if that helps
+	while (Chosen + 1 < LevelCount && OldestTime(Chosen) > Start && OldestTime(Chosen + 1) < OldestTime(Chosen))
+	{
+		Chosen++;
+	}
+
+	const Level& Lv = Levels[Chosen];
+
+	// First bucket that ends after Start
+	uint Low = 0, High = Lv.Size;
+	while (Low < High)
+	{
+		const uint Mid = (Low + High) / 2;
+		if (Lv.At(Mid).Time + Lv.Interval <= Start)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	for (uint i = Low; i < Lv.Size && Lv.At(i).Time <= End; i++)
+	{
+		OutBuckets.push_back(Lv.At(i));
+	}
+
+	if (Lv.Pending.Count > 0 && Lv.Pending.Time <= End && Lv.Pending.Time + Lv.Interval > Start)
+	{
+		OutBuckets.push_back(Lv.Pending);
+	}
+
+	return Chosen;
+}
+
+double TimeSeriesPyramid::GetOldestTime() const
+{
+	for (auto It = Levels.rbegin(); It != Levels.rend(); ++It)
+	{
+		if (It->Size > 0)
+		{
+			return It->At(0).Time;
+		}
+	}
+	return Levels[0].Pending.Count > 0 ? Levels[0].Pending.Time : 0.0;
+}
+
+void TimeSeriesPyramid::Accumulate(uint LevelIndex, double BucketTime, float Min, float Max, double Sum, uint Count)
+{
+	Level& Lv = Levels[LevelIndex];
+	const double Aligned = std::floor(BucketTime / Lv.Interval) * Lv.Interval;
+
+	if (Lv.Pending.Count > 0 && Aligned > Lv.Pending.Time)
+	{
+		Emit(LevelIndex);
+	}
+
+	if (Lv.Pending.Count == 0)
+	{
+		Lv.Pending = { Aligned, Min, Max, 0.f, 0 };
+		Lv.PendingSum = 0.0;
+	}
+
+	Lv.Pending.Min = std::min(Lv.Pending.Min, Min);
+	Lv.Pending.Max = std::max(Lv.Pending.Max, Max);
+	Lv.PendingSum += Sum;
+	Lv.Pending.Count += Count;
+	Lv.Pending.Mean = float(Lv.PendingSum / Lv.Pending.Count);
+}
+
+void TimeSeriesPyramid::Emit(uint LevelIndex)
+{
+	Level& Lv = Levels[LevelIndex];
+	const SeriesBucket Done = Lv.Pending;
+	const double DoneSum = Lv.PendingSum;
+
+	Lv.Ring[Lv.Head] = Done;
+	Lv.Head = (Lv.Head + 1) % uint(Lv.Ring.size());
+	Lv.Size = std::min(Lv.Size + 1, uint(Lv.Ring.size()));
+	Lv.Pending.Count = 0;
+
+	if (LevelIndex + 1 < Levels.size())
+	{
+		Accumulate(LevelIndex + 1, Done.Time, Done.Min, Done.Max, DoneSum, Done.Count);
+	}
+}
+// End- TimeSeriesPyramid
+
+// Begin- HeadingHistory
+void HeadingHistory::Push(double Time, float HeadingDegrees)
+{
+	if (!HasLast)
+	{
+		UnwrappedHeading = HeadingDegrees;
+	}
+	else
+	{
+		const double DeltaTime = Time - LastTime;
+		if (DeltaTime <= 0.0)
+		{
+			return;
+		}
+
+		const float Delta = HeadingMath::ShortestArc(LastHeading, HeadingDegrees);
+		UnwrappedHeading += Delta;
+		RateOfTurn.Push(Time, float(Delta / DeltaTime));
+	}
+
+	Heading.Push(Time, UnwrappedHeading);
+	HasLast = true;
+	LastTime = Time;
+	LastHeading = HeadingDegrees;
+}
+
+void HeadingHistory::Clear()
+{
+	Heading.Clear();
+	RateOfTurn.Clear();
+	HasLast = false;
+}
+// End- HeadingHistory
@@ -0,0 +1,75 @@
+#pragma once
+#include "Core.h"
+#include <vector>
+
+struct SeriesBucket
+{
+	double Time; // Bucket start, seconds
+	float Min;
+	float Max;
+	float Mean;
+	uint Count;
+};
+
+// Fixed-capacity time series stored as a min/max/mean pyramid. Level 0 buckets are BaseInterval
+// seconds wide and every level above is LevelFactor times coarser, each kept in its own ring.
+// A query reads from the finest level that fits the requested point budget, so the cost of a
+// plot is bounded by its pixel width, not by the zoom level or the history length.
+class TimeSeriesPyramid
+{
+public:
+	TimeSeriesPyramid(double InBaseInterval = 0.1, uint InLevelFactor = 8, uint InLevelCount = 4, uint InCapacity = 4096);
+
+	void Push(double Time, float Value);
+	void Clear();
+
+	// Replaces OutBuckets with at most about MaxPoints buckets covering [Start, End], including
+	// the partially filled bucket at the head. Returns the level that was read.
+	uint Query(double Start, double End, uint MaxPoints, std::vector<SeriesBucket>& OutBuckets) const;
+
+	inline uint GetLevelCount() const { return uint(Levels.size()); }
+	inline double GetInterval(uint Level) const { return Levels[Level].Interval; }
+	// Oldest time still held by the coarsest level
+	double GetOldestTime() const;
+
+private:
+	struct Level
+	{
+		double Interval;
+		std::vector<SeriesBucket> Ring;
+		uint Head = 0; // Next write position
+		uint Size = 0;
+		SeriesBucket Pending = { 0.0, 0.f, 0.f, 0.f, 0 };
+		double PendingSum = 0.0;
+
+		inline const SeriesBucket& At(uint Index) const { return Ring[(Head + Ring.size() - Size + Index) % Ring.size()]; }
+	};
+
+	std::vector<Level> Levels;
+
+	void Accumulate(uint LevelIndex, double BucketTime, float Min, float Max, double Sum, uint Count);
+	void Emit(uint LevelIndex);
+};
+
+// Heading and rate-of-turn history for the Control Panel strip charts. Heading is kept unwrapped
+// (continuous across 359 -> 0) so the min/max envelopes stay meaningful; wrap it for display.
+class HeadingHistory
+{
+public:
+	HeadingHistory() = default;
+
+	void Push(double Time, float HeadingDegrees);
+	void Clear();
+
+	inline const TimeSeriesPyramid& GetHeading() const { return Heading; }
+	inline const TimeSeriesPyramid& GetRateOfTurn() const { return RateOfTurn; }
+	inline double GetLatestTime() const { return LastTime; }
+
+private:
+	TimeSeriesPyramid Heading;
+	TimeSeriesPyramid RateOfTurn; // degrees per second
+	bool HasLast = false;
+	double LastTime = 0.0;
+	float LastHeading = 0.f;
+	float UnwrappedHeading = 0.f;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <cmath>
+
+// Angle helpers shared by everything that stores, filters or compares headings (degrees).
+namespace HeadingMath
+{
+	// Wraps any angle into [0, 360)
+	inline float Wrap360(float Degrees)
+	{
+		float Wrapped = std::fmod(Degrees, 360.f);
+		if (Wrapped < 0.f)
+		{
+			Wrapped += 360.f;
+		}
+		return Wrapped >= 360.f ? 0.f : Wrapped;
+	}
+
+	// Signed shortest rotation that takes From to To, in (-180, 180]
+	inline float ShortestArc(float From, float To)
+	{
+		float Delta = To - From;
+		if (Delta > 540.f || Delta < -540.f)
+		{
+			Delta = std::fmod(Delta, 360.f);
+		}
+
+		if (Delta > 180.f)
+		{
+			Delta -= 360.f;
+		}
+		else if (Delta <= -180.f)
+		{
+			Delta += 360.f;
+		}
+		return Delta;
+	}
+}
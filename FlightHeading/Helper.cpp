@@ -1,20 +1,25 @@
 #include "Helper.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 
 // Begin- VertexBuffer
 VertexBuffer::VertexBuffer(const void* Data, uint Size)
+	: MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Buffer, "Vertex buffer"))
 {
 	GLCALL(glGenBuffers(1, &RendererID));
 	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, RendererID));
 	GLCALL(glBufferData(GL_ARRAY_BUFFER, Size, Data, GL_STATIC_DRAW));
+	ResourceMemory::SetBytes(MemoryID, Size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	GLCALL(glDeleteBuffers(1, &RendererID));
+	ResourceMemory::Unregister(MemoryID);
 }
 
 void VertexBuffer::Bind() const
@@ -47,12 +52,12 @@ void VertexArray::AddBuffer(const VertexBuffer& VB, const VertexBufferLayout& VB
 
 	auto& Elements = VBL.GetElements();
 
-	for (int i = 0; i < Elements.size(); i++)
+	for (uint i = 0; i < Elements.size(); i++)
 	{
 		auto& Elm = Elements[i];
 
 		GLCALL(glEnableVertexAttribArray(i));
-		GLCALL(glVertexAttribPointer(i, Elm.Count, Elm.Type, Elm.Normalized, VBL.GetStride(), (const void*)Elm.Offset));
+		GLCALL(glVertexAttribPointer(i, Elm.Count, Elm.Type, Elm.Normalized, VBL.GetStride(), (const void*)(uintptr_t)Elm.Offset));
 	}
 }
 
@@ -69,18 +74,20 @@ void VertexArray::Unbind() const
 
 // Begin- IndexBuffer
 IndexBuffer::IndexBuffer(const uint* Data, uint InCount)
-	: Count(InCount)
+	: MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Buffer, "Index buffer")), Count(InCount)
 {
 	ASSERT(sizeof(GLuint) == sizeof(uint));
 
 	GLCALL(glGenBuffers(1, &RendererID));
 	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, RendererID));
 	GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, Count * sizeof(uint), Data, GL_STATIC_DRAW));
+	ResourceMemory::SetBytes(MemoryID, Count * sizeof(uint));
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	GLCALL(glDeleteBuffers(1, &RendererID));
+	ResourceMemory::Unregister(MemoryID);
 }
 
 void IndexBuffer::Bind() const
@@ -94,28 +101,408 @@ void IndexBuffer::Unbind() const
 }
 // End- IndexBuffer
 
+// Begin- TextureBuffer
+TextureBuffer::TextureBuffer(uint InCapacity)
+	: BufferID(0), RendererID(0), MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Buffer, "Texture buffer")), Capacity(std::max(InCapacity, 1u))
+{
+	GLCALL(glGenBuffers(1, &BufferID));
+	GLCALL(glBindBuffer(GL_TEXTURE_BUFFER, BufferID));
+	GLCALL(glBufferData(GL_TEXTURE_BUFFER, Capacity * 4 * sizeof(float), nullptr, GL_STREAM_DRAW));
+	ResourceMemory::SetBytes(MemoryID, Capacity * 4 * sizeof(float));
+
+	GLCALL(glGenTextures(1, &RendererID));
+	GLCALL(glBindTexture(GL_TEXTURE_BUFFER, RendererID));
+	GLCALL(glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, BufferID));
+}
+
+TextureBuffer::~TextureBuffer()
+{
+	GLCALL(glDeleteTextures(1, &RendererID));
+	GLCALL(glDeleteBuffers(1, &BufferID));
+	ResourceMemory::Unregister(MemoryID);
+}
+
+void TextureBuffer::Update(const float* Data, uint TexelCount)
+{
+	GLCALL(glBindBuffer(GL_TEXTURE_BUFFER, BufferID));
+	if (TexelCount > Capacity)
+	{
+		Capacity = std::max(TexelCount, Capacity * 2);
+		ResourceMemory::SetBytes(MemoryID, Capacity * 4 * sizeof(float));
+	}
+	// Orphaning first lets the driver hand out fresh storage instead of waiting for the previous draw
+	GLCALL(glBufferData(GL_TEXTURE_BUFFER, Capacity * 4 * sizeof(float), nullptr, GL_STREAM_DRAW));
+	GLCALL(glBufferSubData(GL_TEXTURE_BUFFER, 0, TexelCount * 4 * sizeof(float), Data));
+}
+
+void TextureBuffer::Bind(uint Slot) const
+{
+	GLCALL(glActiveTexture(GL_TEXTURE0 + Slot));
+	GLCALL(glBindTexture(GL_TEXTURE_BUFFER, RendererID));
+}
+// End- TextureBuffer
+
+// Begin- UniformBuffer
+UniformBuffer::UniformBuffer(uint InFrameSize, uint InFrameCount)
+	: RendererID(0), MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Buffer, "Uniform buffer")), FrameSize(AlignBlock(std::max(InFrameSize, 16u))), FrameCount(std::max(InFrameCount, 1u)), Frame(0), Staging(FrameSize, 0)
+{
+	GLCALL(glGenBuffers(1, &RendererID));
+	GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, RendererID));
+	GLCALL(glBufferData(GL_UNIFORM_BUFFER, FrameSize * FrameCount, nullptr, GL_DYNAMIC_DRAW));
+	ResourceMemory::SetBytes(MemoryID, FrameSize * FrameCount, FrameSize);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLCALL(glDeleteBuffers(1, &RendererID));
+	ResourceMemory::Unregister(MemoryID);
+}
+
+uint UniformBuffer::GetOffsetAlignment()
+{
+	static const uint Alignment = []()
+	{
+		GLint Value = 256;
+		GLCALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Value));
+		return uint(std::max(Value, 1));
+	}();
+	return Alignment;
+}
+
+void UniformBuffer::BeginFrame()
+{
+	Frame = (Frame + 1) % FrameCount;
+}
+
+void UniformBuffer::Write(uint Offset, const void* Data, uint Size)
+{
+	if (Offset + Size > FrameSize)
+	{
+		ASSERTNOENTRY("Uniform write out of range!");
+		return;
+	}
+	std::memcpy(Staging.data() + Offset, Data, Size);
+}
+
+void UniformBuffer::Upload()
+{
+	GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, RendererID));
+	GLCALL(glBufferSubData(GL_UNIFORM_BUFFER, Frame * FrameSize, FrameSize, Staging.data()));
+}
+
+void UniformBuffer::BindRange(uint BindingPoint, uint Offset, uint Size) const
+{
+	GLCALL(glBindBufferRange(GL_UNIFORM_BUFFER, BindingPoint, RendererID, Frame * FrameSize + Offset, Size));
+}
+// End- UniformBuffer
+
+// Begin- RenderTarget
+RenderTarget::RenderTarget(uint InWidth, uint InHeight, int InSamples)
+	: FrameBufferID(0), ColorBufferID(0), ResolveFrameBufferID(0), TextureID(0), MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Texture, "Render target")),
+	Width(std::max(InWidth, 1u)), Height(std::max(InHeight, 1u)), Samples(InSamples > 1 ? InSamples : 0)
+{
+	Create();
+}
+
+RenderTarget::~RenderTarget()
+{
+	Destroy();
+	ResourceMemory::Unregister(MemoryID);
+}
+
+void RenderTarget::Resize(uint InWidth, uint InHeight)
+{
+	InWidth = std::max(InWidth, 1u);
+	InHeight = std::max(InHeight, 1u);
+	if (InWidth == Width && InHeight == Height)
+	{
+		return;
+	}
+	Destroy();
+	Width = InWidth;
+	Height = InHeight;
+	Create();
+}
+
+void RenderTarget::Create()
+{
+	GLCALL(glGenTextures(1, &TextureID));
+	GLCALL(glBindTexture(GL_TEXTURE_2D, TextureID));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCALL(glBindTexture(GL_TEXTURE_2D, 0));
+
+	GLCALL(glGenFramebuffers(1, &ResolveFrameBufferID));
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, ResolveFrameBufferID));
+	GLCALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, TextureID, 0));
+	ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	FrameBufferID = ResolveFrameBufferID;
+
+	size_t Bytes = ResourceMemory::TextureBytes(Width, Height, 4, false);
+	if (Samples > 1)
+	{
+		GLCALL(glGenRenderbuffers(1, &ColorBufferID));
+		GLCALL(glBindRenderbuffer(GL_RENDERBUFFER, ColorBufferID));
+		GLCALL(glRenderbufferStorageMultisample(GL_RENDERBUFFER, Samples, GL_RGBA8, Width, Height));
+		GLCALL(glGenFramebuffers(1, &FrameBufferID));
+		GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, FrameBufferID));
+		GLCALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBufferID));
+		ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+		Bytes += ResourceMemory::TextureBytes(Width, Height, 4, false) * Samples;
+	}
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	ResourceMemory::SetBytes(MemoryID, Bytes);
+}
+
+void RenderTarget::Destroy()
+{
+	if (FrameBufferID != ResolveFrameBufferID)
+	{
+		GLCALL(glDeleteFramebuffers(1, &FrameBufferID));
+		GLCALL(glDeleteRenderbuffers(1, &ColorBufferID));
+	}
+	GLCALL(glDeleteFramebuffers(1, &ResolveFrameBufferID));
+	GLCALL(glDeleteTextures(1, &TextureID));
+	FrameBufferID = ColorBufferID = ResolveFrameBufferID = TextureID = 0;
+}
+
+void RenderTarget::Bind(uint DrawWidth, uint DrawHeight) const
+{
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, FrameBufferID));
+	GLCALL(glViewport(0, 0, std::min(DrawWidth, Width), std::min(DrawHeight, Height)));
+}
+
+void RenderTarget::Resolve(uint DrawWidth, uint DrawHeight) const
+{
+	if (FrameBufferID == ResolveFrameBufferID)
+	{
+		return;
+	}
+	DrawWidth = std::min(DrawWidth, Width);
+	DrawHeight = std::min(DrawHeight, Height);
+	GLCALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, FrameBufferID));
+	GLCALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ResolveFrameBufferID));
+	GLCALL(glBlitFramebuffer(0, 0, DrawWidth, DrawHeight, 0, 0, DrawWidth, DrawHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void RenderTarget::BindTexture(uint Slot) const
+{
+	GLCALL(glActiveTexture(GL_TEXTURE0 + Slot));
+	GLCALL(glBindTexture(GL_TEXTURE_2D, TextureID));
+}
+// End- RenderTarget
+
+// Begin- GpuTimer
+GpuTimer::GpuTimer(uint QueryCount)
+	: Queries(std::max(QueryCount, 2u), 0), Next(0), Pending(0), Running(false)
+{
+	GLCALL(glGenQueries(GLsizei(Queries.size()), Queries.data()));
+}
+
+GpuTimer::~GpuTimer()
+{
+	GLCALL(glDeleteQueries(GLsizei(Queries.size()), Queries.data()));
+}
+
+void GpuTimer::Begin()
+{
+	if (Running || Pending == Queries.size())
+	{
+		return;
+	}
+	GLCALL(glBeginQuery(GL_TIME_ELAPSED, Queries[Next]));
+	Running = true;
+}
+
+void GpuTimer::End()
+{
+	if (!Running)
+	{
+		return;
+	}
+	GLCALL(glEndQuery(GL_TIME_ELAPSED));
+	Running = false;
+	Next = (Next + 1) % Queries.size();
+	Pending++;
+}
+
+bool GpuTimer::TakeResult(float& OutMs)
+{
+	if (Pending == 0)
+	{
+		return false;
+	}
+
+	const uint Oldest = uint((Next + Queries.size() - Pending) % Queries.size());
+	GLint Available = 0;
+	GLCALL(glGetQueryObjectiv(Queries[Oldest], GL_QUERY_RESULT_AVAILABLE, &Available));
+	if (!Available)
+	{
+		return false;
+	}
+
+	GLuint64 Nanoseconds = 0;
+	GLCALL(glGetQueryObjectui64v(Queries[Oldest], GL_QUERY_RESULT, &Nanoseconds));
+	Pending--;
+	OutMs = float(Nanoseconds / 1e6);
+	return true;
+}
+// End- GpuTimer
+
 // Begin- Texture
+DecodedImage DecodedImage::Load(const std::string& Path, bool FlipUV)
+{
+	// The thread variant, reloads decode on a background thread
+	stbi_set_flip_vertically_on_load_thread(FlipUV);
+	DecodedImage Image;
+	Image.Pixels = stbi_load(Path.c_str(), &Image.Width, &Image.Height, &Image.BPP, 0);
+	return Image;
+}
+
+void DecodedImage::Free()
+{
+	stbi_image_free(Pixels);
+	Pixels = nullptr;
+}
+
+void DecodedImage::PremultiplyAlpha(bool Gamma)
+{
+	// Alpha is the last channel of gray + alpha and RGBA
+	if (!Pixels || (BPP != 2 && BPP != 4))
+	{
+		return;
+	}
+
+	static const std::vector<float> SrgbToLinear = []()
+	{
+		std::vector<float> Table(256);
+		for (uint Value = 0; Value < 256; Value++)
+		{
+			const float Srgb = Value / 255.f;
+			Table[Value] = Srgb <= 0.04045f ? Srgb / 12.92f : std::pow((Srgb + 0.055f) / 1.055f, 2.4f);
+		}
+		return Table;
+	}();
+
+	const size_t PixelCount = size_t(Width) * Height;
+	for (size_t Pixel = 0; Pixel < PixelCount; Pixel++)
+	{
+		uchar* Texel = Pixels + Pixel * BPP;
+		const uint Alpha = Texel[BPP - 1];
+		if (Alpha == 255)
+		{
+			continue;
+		}
+
+		for (int Channel = 0; Channel < BPP - 1; Channel++)
+		{
+			if (Gamma)
+			{
+				const float Linear = SrgbToLinear[Texel[Channel]] * (Alpha / 255.f);
+				const float Srgb = Linear <= 0.0031308f ? Linear * 12.92f : 1.055f * std::pow(Linear, 1.f / 2.4f) - 0.055f;
+				Texel[Channel] = uchar(Srgb * 255.f + 0.5f);
+			}
+			else
+			{
+				Texel[Channel] = uchar((Texel[Channel] * Alpha + 127) / 255);
+			}
+		}
+	}
+}
+
+Texture::Texture(const std::string& Path, bool InFlipUV /*= true*/, bool InGamma/* = false*/, GLenum InRepeatMode /*= GL_REPEAT*/, bool InRetainPixels /*= false*/, bool InPremultiplyAlpha /*= false*/)
+	: RendererID(0), MemoryID(0), FilePath(Path), LocalBuffer(nullptr), Width(0), Height(0), BPP(0), FlipUV(InFlipUV), Gamma(InGamma), RetainPixels(InRetainPixels), PremultiplyAlpha(InPremultiplyAlpha), RepeatMode(InRepeatMode)
+{
+	if (!Decode())
+	{
+		return;
+	}
+
+	MemoryID = ResourceMemory::Register(ResourceMemory::Kind::Texture, FilePath, [this]() { Evict(); });
+	Upload();
+}
 
-Texture::Texture(const std::string& Path, bool FlipUV /*= true*/, bool Gamma/* = false*/, GLenum RepeatMode /*= GL_REPEAT*/)
-	: RendererID(0), FilePath(Path), LocalBuffer(nullptr), Width(0), Height(0), BPP(0)
+Texture::~Texture()
 {
-	stbi_set_flip_vertically_on_load(FlipUV);
-	LocalBuffer = stbi_load(FilePath.c_str(), &Width, &Height, &BPP, 0);
+	GLCALL(glDeleteTextures(1, &RendererID));
+	stbi_image_free(LocalBuffer);
+	ResourceMemory::Unregister(MemoryID);
+}
+
+void Texture::Replace(DecodedImage Image)
+{
+	if (!Image.Pixels)
+	{
+		return;
+	}
+
+	GLCALL(glDeleteTextures(1, &RendererID));
+	RendererID = 0;
+	stbi_image_free(LocalBuffer);
+	LocalBuffer = Image.Pixels;
+	Width = Image.Width;
+	Height = Image.Height;
+	BPP = Image.BPP;
+
+	if (!MemoryID)
+	{
+		MemoryID = ResourceMemory::Register(ResourceMemory::Kind::Texture, FilePath, [this]() { Evict(); });
+	}
+	Upload();
+}
+
+void Texture::Bind(uint Slot)
+{
+	GLCALL(glActiveTexture(GL_TEXTURE0 + Slot));
+	if (!RendererID && MemoryID && (LocalBuffer || Decode()))
+	{
+		Upload();
+	}
+
+	ResourceMemory::Touch(MemoryID);
+	GLCALL(glBindTexture(GL_TEXTURE_2D, RendererID));
+}
+
+bool Texture::Decode()
+{
+	DecodedImage Image = DecodedImage::Load(FilePath, FlipUV);
+	if (PremultiplyAlpha)
+	{
+		Image.PremultiplyAlpha(Gamma);
+	}
+	LocalBuffer = Image.Pixels;
+	Width = Image.Width;
+	Height = Image.Height;
+	BPP = Image.BPP;
 
 	if (!LocalBuffer)
 	{
 		ASSERTNOENTRY("STBI_LOAD FAILED.");
-		return;
+		return false;
 	}
+	return true;
+}
 
-	GLenum Format;
-	GLenum InternalFormat;
+void Texture::Upload()
+{
+	GLenum Format = GL_RGBA;
+	GLenum InternalFormat = GL_RGBA;
 
 	if (BPP == 1)
 	{
 		Format = GL_RED;
 		InternalFormat = GL_RED;
 	}
+	else if (BPP == 2)
+	{
+		// Gray + alpha, read back as gray in RGB and alpha in A
+		Format = GL_RG;
+		InternalFormat = GL_RG8;
+	}
 	else if (BPP == 3)
 	{
 		Format = GL_RGB;
@@ -129,7 +516,15 @@ Texture::Texture(const std::string& Path, bool FlipUV /*= true*/, bool Gamma/* =
 
 	GLCALL(glGenTextures(1, &RendererID));
 	GLCALL(glBindTexture(GL_TEXTURE_2D, RendererID));
+	// stb_image rows are tightly packed, which with 1 to 3 bytes per texel is not always 4 byte aligned
+	GLCALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, Width, Height, 0, Format, GL_UNSIGNED_BYTE, LocalBuffer));
+	GLCALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	if (BPP == 2)
+	{
+		const GLint Swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		GLCALL(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, Swizzle));
+	}
 
 	GLCALL(glGenerateMipmap(GL_TEXTURE_2D));
 
@@ -137,28 +532,75 @@ Texture::Texture(const std::string& Path, bool FlipUV /*= true*/, bool Gamma/* =
 	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, RepeatMode));
 	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
 	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-}
 
-Texture::~Texture()
-{
-	GLCALL(glDeleteTextures(1, &RendererID));
-	delete LocalBuffer;
+	if (!RetainPixels)
+	{
+		stbi_image_free(LocalBuffer);
+		LocalBuffer = nullptr;
+	}
+
+	// Drivers store RGB with a padding byte
+	const uint GpuTexelBytes = BPP == 3 ? 4 : uint(BPP);
+	const size_t CpuBytes = LocalBuffer ? size_t(Width) * Height * BPP : 0;
+	ResourceMemory::SetBytes(MemoryID, ResourceMemory::TextureBytes(Width, Height, GpuTexelBytes, true), CpuBytes);
 }
 
-void Texture::Bind(uint Slot) const
+void Texture::Evict()
 {
-	GLCALL(glActiveTexture(GL_TEXTURE0 + Slot));
-	GLCALL(glBindTexture(GL_TEXTURE_2D, RendererID));
+	GLCALL(glDeleteTextures(1, &RendererID));
+	RendererID = 0;
 }
 
 // End- Texture
 
 // Begin- Shader
-Shader::Shader(const std::string& VertexPath, const std::string& FragmentPath)
+Shader::Shader(const std::string& InVertexPath, const std::string& InFragmentPath, const std::vector<std::string>& InDefines)
+	: RendererID(0), VertexPath(InVertexPath), FragmentPath(InFragmentPath), Defines(InDefines)
 {
-	std::string VertexSource = ReadShader(VertexPath);
-	std::string FragmentSource = ReadShader(FragmentPath);
+	ShaderSource VertexSource;
+	ShaderSource FragmentSource;
+	if (!ShaderSource::Load(VertexPath, Defines, VertexSource) || !ShaderSource::Load(FragmentPath, Defines, FragmentSource))
+	{
+		ASSERTNOENTRY("Could not open file!");
+		return;
+	}
+
 	RendererID = CreateShader(VertexSource, FragmentSource);
+	if (!RendererID)
+	{
+		ASSERTNOENTRY("Shader compilation error!");
+		return;
+	}
+
+	Dependencies = VertexSource.Files;
+	Dependencies.insert(Dependencies.end(), FragmentSource.Files.begin(), FragmentSource.Files.end());
+}
+
+bool Shader::Rebuild(const ShaderSource& VertexSource, const ShaderSource& FragmentSource)
+{
+	const uint Program = CreateShader(VertexSource, FragmentSource);
+	if (!Program)
+	{
+		std::cout << "Keeping the previous program of " << VertexPath << " and " << FragmentPath << std::endl;
+		return false;
+	}
+
+	GLCALL(glDeleteProgram(RendererID));
+	RendererID = Program;
+	Dependencies = VertexSource.Files;
+	Dependencies.insert(Dependencies.end(), FragmentSource.Files.begin(), FragmentSource.Files.end());
+
+	const std::vector<std::pair<std::string, uint>> Blocks = BlockBindings;
+	for (const auto& Block : Blocks)
+	{
+		BindUniformBlock(Block.first, Block.second);
+	}
+	const std::vector<std::pair<std::string, int>> Uniforms = IntUniforms;
+	for (const auto& Uniform : Uniforms)
+	{
+		SetUniform1i(Uniform.first, Uniform.second);
+	}
+	return true;
 }
 
 Shader::~Shader()
@@ -176,8 +618,18 @@ void Shader::Unbind() const
 	GLCALL(glUseProgram(0));
 }
 
-void Shader::SetUniform1i(const std::string& Name, int Value) const
+void Shader::SetUniform1i(const std::string& Name, int Value)
 {
+	auto Found = std::find_if(IntUniforms.begin(), IntUniforms.end(), [&](const std::pair<std::string, int>& Uniform) { return Uniform.first == Name; });
+	if (Found == IntUniforms.end())
+	{
+		IntUniforms.emplace_back(Name, Value);
+	}
+	else
+	{
+		Found->second = Value;
+	}
+
 	Bind();
 	int Loc = GetUniformLocation(Name);
 	if (Loc == -1)
@@ -188,6 +640,18 @@ void Shader::SetUniform1i(const std::string& Name, int Value) const
 	GLCALL(glUniform1i(Loc, Value));
 }
 
+void Shader::SetUniform2f(const std::string& Name, const glm::vec2& Value) const
+{
+	Bind();
+	int Loc = GetUniformLocation(Name);
+	if (Loc == -1)
+	{
+		return;
+	}
+
+	GLCALL(glUniform2f(Loc, Value.x, Value.y));
+}
+
 void Shader::SetUniformMatrix4f(const std::string& Name, const glm::mat4& Matrix) const
 {
 	Bind();
@@ -200,25 +664,43 @@ void Shader::SetUniformMatrix4f(const std::string& Name, const glm::mat4& Matrix
 	GLCALL(glUniformMatrix4fv(Loc, 1, GL_FALSE, &Matrix[0][0]));
 }
 
-const std::string Shader::ReadShader(const std::string& Filepath) const
+void Shader::SetUniformAffine2D(const std::string& Name, const Affine2D& Transform) const
 {
-	std::ifstream Stream(Filepath);
-
-	if (!Stream.is_open())
+	Bind();
+	int Loc = GetUniformLocation(Name);
+	if (Loc == -1)
 	{
-		ASSERTNOENTRY("Could not open file!");
-		return "";
+		return;
 	}
 
-	std::string Line;
-	std::stringstream ReadShader;
+	// mat3x2: three columns of two
+	GLCALL(glUniformMatrix3x2fv(Loc, 1, GL_FALSE, Transform.Data()));
+}
 
-	while (getline(Stream, Line))
+void Shader::BindUniformBlock(const std::string& BlockName, uint BindingPoint)
+{
+	auto Found = std::find_if(BlockBindings.begin(), BlockBindings.end(), [&](const std::pair<std::string, uint>& Block) { return Block.first == BlockName; });
+	if (Found == BlockBindings.end())
+	{
+		BlockBindings.emplace_back(BlockName, BindingPoint);
+	}
+	else
 	{
-		ReadShader << Line << '\n';
+		Found->second = BindingPoint;
 	}
 
-	return ReadShader.str();
+	GLCALL(const uint Index = glGetUniformBlockIndex(RendererID, BlockName.c_str()));
+	if (Index == GL_INVALID_INDEX)
+	{
+		return;
+	}
+
+	GLCALL(glUniformBlockBinding(RendererID, Index, BindingPoint));
+}
+
+bool Shader::DependsOn(const std::string& Path) const
+{
+	return Path == VertexPath || Path == FragmentPath || std::find(Dependencies.begin(), Dependencies.end(), Path) != Dependencies.end();
 }
 
 int Shader::GetUniformLocation(const std::string& Uniformname) const
@@ -233,10 +715,10 @@ int Shader::GetUniformLocation(const std::string& Uniformname) const
 	return Location;
 }
 
-uint Shader::CompileShader(uint Type, const std::string& Source) const
+uint Shader::CompileShader(uint Type, const ShaderSource& Source) const
 {
 	uint Id = glCreateShader(Type);
-	const char* Src = Source.c_str();
+	const char* Src = Source.Text.c_str();
 	GLCALL(glShaderSource(Id, 1, &Src, nullptr));
 	GLCALL(glCompileShader(Id));
 
@@ -246,26 +728,36 @@ uint Shader::CompileShader(uint Type, const std::string& Source) const
 	{
 		int Length;
 		GLCALL(glGetShaderiv(Id, GL_INFO_LOG_LENGTH, &Length));
-		char* Message = (char*)alloca(Length * sizeof(char));
+		std::vector<char> Message(std::max(Length, 1), '\0');
 
-		GLCALL(glGetShaderInfoLog(Id, Length, &Length, Message));
+		GLCALL(glGetShaderInfoLog(Id, Length, &Length, Message.data()));
 
 		GLCALL(glDeleteShader(Id));
 
-		std::cout << "Failed to compile shader. Message: " << Message << std::endl;
-		ASSERTNOENTRY("Shader compilation error!");
+		std::cout << "Failed to compile shader. Message: " << Message.data() << std::endl;
+		// Messages give lines as source string number(line)
+		for (size_t File = 0; File < Source.Files.size(); File++)
+		{
+			std::cout << "  " << File << ": " << Source.Files[File] << std::endl;
+		}
 		return 0;
 	}
 
 	return Id;
 }
 
-uint Shader::CreateShader(const std::string& VertexShader, const std::string& FragmentShader) const
+uint Shader::CreateShader(const ShaderSource& VertexShader, const ShaderSource& FragmentShader) const
 {
-	uint Program = glCreateProgram();
 	uint VS = CompileShader(GL_VERTEX_SHADER, VertexShader);
 	uint FS = CompileShader(GL_FRAGMENT_SHADER, FragmentShader);
+	if (!VS || !FS)
+	{
+		GLCALL(glDeleteShader(FS));
+		GLCALL(glDeleteShader(VS));
+		return 0;
+	}
 
+	uint Program = glCreateProgram();
 	GLCALL(glAttachShader(Program, VS));
 	GLCALL(glAttachShader(Program, FS));
 
@@ -275,6 +767,22 @@ uint Shader::CreateShader(const std::string& VertexShader, const std::string& Fr
 	GLCALL(glDeleteShader(FS));
 	GLCALL(glDeleteShader(VS));
 
+	int Result;
+	GLCALL(glGetProgramiv(Program, GL_LINK_STATUS, &Result));
+	if (Result == GL_FALSE)
+	{
+		int Length;
+		GLCALL(glGetProgramiv(Program, GL_INFO_LOG_LENGTH, &Length));
+		std::vector<char> Message(std::max(Length, 1), '\0');
+
+		GLCALL(glGetProgramInfoLog(Program, Length, &Length, Message.data()));
+
+		GLCALL(glDeleteProgram(Program));
+
+		std::cout << "Failed to link shader. Message: " << Message.data() << std::endl;
+		return 0;
+	}
+
 	return Program;
 }
 
@@ -1,5 +1,8 @@
 #pragma once
 #include "Core.h"
+#include "Affine2D.h"
+#include "ResourceMemory.h"
+#include "ShaderSource.h"
 #include <vector>
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
@@ -17,6 +20,7 @@ public:
 
 private:
 	uint RendererID;
+	uint MemoryID;
 };
 
 struct VertexBufferElement
@@ -91,47 +95,239 @@ public:
 
 private:
 	uint RendererID;
+	uint MemoryID;
 	uint Count;
 };
 
+// Buffer texture of RGBA32F texels (samplerBuffer in GLSL), for per-instance data that the vertex
+// shader fetches with texelFetch instead of vertex attributes
+class TextureBuffer : public Useful::NonCopyable
+{
+public:
+	explicit TextureBuffer(uint InCapacity);
+	TextureBuffer() = delete;
+	~TextureBuffer();
+
+	// Replaces the contents; TexelCount vec4s, growing the buffer when needed
+	void Update(const float* Data, uint TexelCount);
+	void Bind(uint Slot = 0) const;
+	inline uint GetCapacity() const { return Capacity; }
+
+private:
+	uint BufferID;
+	uint RendererID;
+	uint MemoryID;
+	uint Capacity;
+};
+
+// Member offsets of a std140 uniform block, pushed in declaration order
+class Std140Layout
+{
+public:
+	inline uint PushFloat() { return Push(4, 4); }
+	inline uint PushInt() { return Push(4, 4); }
+	inline uint PushVec2() { return Push(8, 8); }
+	inline uint PushVec3() { return Push(16, 12); }
+	inline uint PushVec4() { return Push(16, 16); }
+	inline uint PushMat3x2() { return Push(16, 48); } // Three vec2 columns, each padded to a vec4
+	inline uint PushMat4() { return Push(16, 64); }
+
+	// Block size, padded to a vec4 like the block itself
+	inline uint GetSize() const { return (Size + 15) & ~15u; }
+
+private:
+	uint Size = 0;
+
+	inline uint Push(uint Alignment, uint MemberSize)
+	{
+		const uint Offset = (Size + Alignment - 1) / Alignment * Alignment;
+		Size = Offset + MemberSize;
+		return Offset;
+	}
+};
+
+// Ring of per-frame copies of a uniform buffer. A frame writes all of its blocks into CPU staging,
+// uploads them with one glBufferSubData into the next slot of the ring and binds each block with
+// glBindBufferRange, so the GPU can still be reading the slots of earlier frames.
+class UniformBuffer : public Useful::NonCopyable
+{
+public:
+	explicit UniformBuffer(uint InFrameSize, uint InFrameCount = 3);
+	UniformBuffer() = delete;
+	~UniformBuffer();
+
+	// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; blocks bound by range have to start on a multiple of it
+	static uint GetOffsetAlignment();
+	static inline uint AlignBlock(uint Size)
+	{
+		const uint Alignment = GetOffsetAlignment();
+		return (Size + Alignment - 1) / Alignment * Alignment;
+	}
+
+	// Moves to the next slot of the ring
+	void BeginFrame();
+	void Write(uint Offset, const void* Data, uint Size);
+	template<typename T>
+	inline void Write(uint Offset, const T& Value) { Write(Offset, &Value, sizeof(T)); }
+	// Uploads everything written since BeginFrame
+	void Upload();
+	// Offset is relative to the current frame
+	void BindRange(uint BindingPoint, uint Offset, uint Size) const;
+
+private:
+	uint RendererID;
+	uint MemoryID;
+	uint FrameSize;
+	uint FrameCount;
+	uint Frame;
+	std::vector<uchar> Staging;
+};
+
+// Offscreen color target for drawing at a lower resolution than the window. Draws go to the
+// Width x Height corner; with Samples > 1 they go to a multisampled renderbuffer that Resolve blits
+// into the texture, so alpha-to-coverage keeps working.
+class RenderTarget : public Useful::NonCopyable
+{
+public:
+	RenderTarget(uint InWidth, uint InHeight, int InSamples = 0);
+	RenderTarget() = delete;
+	~RenderTarget();
+
+	// Reallocates at the new size, the contents are lost
+	void Resize(uint InWidth, uint InHeight);
+	// Binds for drawing with the viewport on the Width x Height corner
+	void Bind(uint Width, uint Height) const;
+	// Makes the Width x Height corner readable through the texture
+	void Resolve(uint Width, uint Height) const;
+	void BindTexture(uint Slot = 0) const;
+
+	inline uint GetWidth() const { return Width; }
+	inline uint GetHeight() const { return Height; }
+	inline int GetSamples() const { return Samples; }
+
+private:
+	uint FrameBufferID;
+	uint ColorBufferID; // Multisampled renderbuffer, 0 when single sampled
+	uint ResolveFrameBufferID;
+	uint TextureID;
+	uint MemoryID;
+	uint Width, Height;
+	int Samples;
+
+	void Create();
+	void Destroy();
+};
+
+// GL_TIME_ELAPSED queries in a ring, so reading a result never stalls on the GPU: results come back
+// a frame or two after End, and Begin skips a frame while every query is still pending.
+class GpuTimer : public Useful::NonCopyable
+{
+public:
+	explicit GpuTimer(uint QueryCount = 4);
+	~GpuTimer();
+
+	void Begin();
+	void End();
+	// Oldest finished measurement in milliseconds, false when none is ready
+	bool TakeResult(float& OutMs);
+
+private:
+	std::vector<uint> Queries;
+	uint Next;    // Query the next Begin uses
+	uint Pending; // Ended and not read yet
+	bool Running;
+};
+
+// Pixels decoded by stb_image. Load is safe on any thread; whoever ends up holding the pixels frees them.
+struct DecodedImage
+{
+	uchar* Pixels = nullptr;
+	int Width = 0, Height = 0, BPP = 0;
+
+	static DecodedImage Load(const std::string& Path, bool FlipUV);
+	void Free();
+	// Multiplies color by alpha, in linear space for sRGB (Gamma) images, so mipmaps generated from
+	// the result average correctly and blending can use ONE, ONE_MINUS_SRC_ALPHA
+	void PremultiplyAlpha(bool Gamma);
+};
+
+// Decoded pixels are freed as soon as they are uploaded unless RetainPixels, and premultiplied before
+// the upload (and so before the mipmaps are generated) with PremultiplyAlpha. Textures are counted
+// by ResourceMemory, and one evicted to stay within the budget is restored when next bound, from
+// the retained pixels or by decoding Path again.
 class Texture : public Useful::NonCopyable
 {
 public:
 	Texture() = delete;
-	Texture(const std::string& Path, bool FlipUV = true, bool Gamma = false, GLenum RepeatMode = GL_REPEAT);
+	Texture(const std::string& Path, bool InFlipUV = true, bool InGamma = false, GLenum InRepeatMode = GL_REPEAT, bool InRetainPixels = false, bool InPremultiplyAlpha = false);
 	~Texture();
 
-	void Bind(uint Slot = 0) const;
+	void Bind(uint Slot = 0);
+	// Uploads Image in place of the current pixels and takes ownership of it, for hot reloading.
+	// Image is expected premultiplied already when the texture is.
+	void Replace(DecodedImage Image);
 
 	inline int GetWidth() const { return Width; }
 	inline int GetHeight() const { return Height; }
 	inline std::string GetFilePath() const { return FilePath; }
+	// Null unless the pixels are retained
+	inline const uchar* GetPixels() const { return LocalBuffer; }
+	inline bool IsResident() const { return RendererID != 0; }
 
 	inline uint GetID() const { return RendererID; }
 private:
 	uint RendererID;
+	uint MemoryID;
 	std::string FilePath;
 	uchar* LocalBuffer;
 	int Width, Height, BPP;
+	bool FlipUV, Gamma, RetainPixels, PremultiplyAlpha;
+	GLenum RepeatMode;
+
+	bool Decode();
+	void Upload();
+	void Evict();
 };
 
 class Shader : public Useful::NonCopyable
 {
 public:
 	Shader() = delete;
-	Shader(const std::string& VertexPath, const std::string& FragmentPath);
+	// Builds the permutation of the two files selected by Defines, see ShaderSource
+	Shader(const std::string& InVertexPath, const std::string& InFragmentPath, const std::vector<std::string>& InDefines = {});
 	~Shader();
 
+	// Swaps in a program built from the given sources, with the block bindings and integer uniforms
+	// of the current one. A source that fails to compile or link keeps the current program.
+	bool Rebuild(const ShaderSource& VertexSource, const ShaderSource& FragmentSource);
+	// Whether Path is one of the files or includes the program was built from
+	bool DependsOn(const std::string& Path) const;
+
+	inline const std::string& GetVertexPath() const { return VertexPath; }
+	inline const std::string& GetFragmentPath() const { return FragmentPath; }
+	inline const std::vector<std::string>& GetDefines() const { return Defines; }
+
 	void Bind() const;
 	void Unbind() const;
 
-	void SetUniform1i(const std::string& Name, int Value) const;
+	void SetUniform1i(const std::string& Name, int Value);
+	void SetUniform2f(const std::string& Name, const glm::vec2& Value) const;
 	void SetUniformMatrix4f(const std::string& Name, const glm::mat4& Matrix) const;
+	void SetUniformAffine2D(const std::string& Name, const Affine2D& Transform) const;
+	// Connects a uniform block to a binding point of UniformBuffer::BindRange
+	void BindUniformBlock(const std::string& BlockName, uint BindingPoint);
 	
 private:
 	uint RendererID;
-	const std::string ReadShader(const std::string& Filepath) const;
-	uint CompileShader(uint Type, const std::string& Source) const;
-	uint CreateShader(const std::string& VertexShader, const std::string& FragmentShader) const;
+	std::string VertexPath;
+	std::string FragmentPath;
+	std::vector<std::string> Defines;
+	std::vector<std::string> Dependencies;
+	// Program state that Rebuild carries over
+	std::vector<std::pair<std::string, uint>> BlockBindings;
+	std::vector<std::pair<std::string, int>> IntUniforms;
+
+	uint CompileShader(uint Type, const ShaderSource& Source) const;
+	uint CreateShader(const ShaderSource& VertexShader, const ShaderSource& FragmentShader) const;
 	int GetUniformLocation(const std::string& Uniformname) const;
 };
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "MagneticModel.h"
+#include "HeadingMath.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr double Pi = 3.14159265358979323846;
+	constexpr double DegreesToRadians = Pi / 180.0;
+	constexpr uint Stride = MagneticModel::MaxDegree + 1;
+
+	// WGS-84 ellipsoid and the model's reference radius, km
+	constexpr double EllipsoidA = 6378.137;
+	constexpr double EllipsoidF = 1.0 / 298.257223563;
+	constexpr double EllipsoidE2 = EllipsoidF * (2.0 - EllipsoidF);
+	constexpr double ReferenceRadius = 6371.2;
+
+	// Schmidt semi-normalization factors for the Gauss-normalized Legendre recursion
+	const std::vector<double>& SchmidtFactors()
+	{
+		static const std::vector<double> Factors = []()
+		{
+			std::vector<double> S(Stride * Stride, 0.0);
+			S[0] = 1.0;
+			for (uint N = 1; N < Stride; N++)
+			{
+				S[N * Stride] = S[(N - 1) * Stride] * double(2 * N - 1) / double(N);
+				for (uint M = 1; M <= N; M++)
+				{
+					S[N * Stride + M] = S[N * Stride + M - 1] * std::sqrt(double(N - M + 1) * (M == 1 ? 2.0 : 1.0) / double(N + M));
+				}
+			}
+			return S;
+		}();
+		return Factors;
+	}
+
+	struct GridHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint32_t Rows;
+		uint32_t Columns;
+		float Step;
+		uint32_t Reserved;
+		double DecimalYear;
+		double ModelEpoch;
+	};
+	static_assert(sizeof(GridHeader) == 40, "Grid header layout changed");
+
+	constexpr char GridMagic[4] = { 'F', 'H', 'D', 'G' };
+	constexpr uint32_t GridVersion = 1;
+}
+
+// Begin- MagneticModel
+MagneticModel::MagneticModel(double InEpoch)
+	: Epoch(InEpoch), G(Stride * Stride, 0.0), H(Stride * Stride, 0.0), GDot(Stride * Stride, 0.0), HDot(Stride * Stride, 0.0)
+{
+}
+
+bool MagneticModel::Load(const std::string& Path)
+{
+	std::ifstream Stream(Path);
+	if (!Stream.is_open())
+	{
+		return false;
+	}
+
+	std::string Line;
+	double FileEpoch = 0.0;
+	std::string FileName;
+	if (!std::getline(Stream, Line) || !(std::istringstream(Line) >> FileEpoch >> FileName))
+	{
+		std::cout << "Not a magnetic model coefficient file: " << Path << std::endl;
+		return false;
+	}
+
+	*this = MagneticModel(FileEpoch);
+	Name = FileName;
+	while (std::getline(Stream, Line))
+	{
+		if (Line.compare(0, 4, "9999") == 0)
+		{
+			break;
+		}
+
+		std::istringstream Fields(Line);
+		uint N = 0, M = 0;
+		double Gnm = 0.0, Hnm = 0.0, GDotnm = 0.0, HDotnm = 0.0;
+		if (Fields >> N >> M >> Gnm >> Hnm >> GDotnm >> HDotnm)
+		{
+			SetCoefficient(N, M, Gnm, Hnm, GDotnm, HDotnm);
+		}
+	}
+
+	if (Degree == 0)
+	{
+		std::cout << "No coefficients in magnetic model: " << Path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void MagneticModel::SetCoefficient(uint N, uint M, double Gnm, double Hnm, double GDotnm, double HDotnm)
+{
+	if (N == 0 || N > MaxDegree || M > N)
+	{
+		ASSERTNOENTRY("Coefficient out of range!");
+		return;
+	}
+	const uint Index = N * Stride + M;
+	G[Index] = Gnm;
+	H[Index] = Hnm;
+	GDot[Index] = GDotnm;
+	HDot[Index] = HDotnm;
+	Degree = std::max(Degree, N);
+}
+
+MagneticField MagneticModel::Evaluate(double LatitudeDegrees, double LongitudeDegrees, double AltitudeKm, double DecimalYear) const
+{
+	MagneticField Field;
+	if (Degree == 0)
+	{
+		return Field;
+	}
+
+	// The poles are singular in the east component
+	const double Latitude = std::min(std::max(LatitudeDegrees, -89.999), 89.999) * DegreesToRadians;
+	const double Longitude = LongitudeDegrees * DegreesToRadians;
+	const double Dt = DecimalYear - Epoch;
+
+	// Geodetic to geocentric spherical
+	const double SinLat = std::sin(Latitude), CosLat = std::cos(Latitude);
+	const double Rc = EllipsoidA / std::sqrt(1.0 - EllipsoidE2 * SinLat * SinLat);
+	const double P = (Rc + AltitudeKm) * CosLat;
+	const double Z = (Rc * (1.0 - EllipsoidE2) + AltitudeKm) * SinLat;
+	const double Radius = std::sqrt(P * P + Z * Z);
+	const double GeocentricLatitude = std::asin(Z / Radius);
+
+	// Legendre functions of cos(colatitude), Gauss normalized, and their colatitude derivatives
+	const double C = std::sin(GeocentricLatitude);
+	const double S = std::cos(GeocentricLatitude);
+	double Legendre[Stride * Stride] = {};
+	double DLegendre[Stride * Stride] = {};
+	Legendre[0] = 1.0;
+	for (uint N = 1; N <= Degree; N++)
+	{
+		for (uint M = 0; M <= N; M++)
+		{
+			const uint I = N * Stride + M;
+			if (N == M)
+			{
+				const uint Prev = (N - 1) * Stride + M - 1;
+				Legendre[I] = S * Legendre[Prev];
+				DLegendre[I] = S * DLegendre[Prev] + C * Legendre[Prev];
+			}
+			else
+			{
+				const uint Prev = (N - 1) * Stride + M;
+				const double K = N == 1 ? 0.0 : (double((N - 1) * (N - 1)) - double(M * M)) / (double(2 * N - 1) * double(2 * N - 3));
+				const double Prev2 = N >= 2 ? Legendre[(N - 2) * Stride + M] : 0.0;
+				const double DPrev2 = N >= 2 ? DLegendre[(N - 2) * Stride + M] : 0.0;
+				Legendre[I] = C * Legendre[Prev] - K * Prev2;
+				DLegendre[I] = C * DLegendre[Prev] - S * Legendre[Prev] - K * DPrev2;
+			}
+		}
+	}
+
+	double CosM[Stride], SinM[Stride];
+	for (uint M = 0; M <= Degree; M++)
+	{
+		CosM[M] = std::cos(M * Longitude);
+		SinM[M] = std::sin(M * Longitude);
+	}
+
+	const std::vector<double>& Schmidt = SchmidtFactors();
+	const double Ratio = ReferenceRadius / Radius;
+	double RatioPower = Ratio * Ratio;
+	double North = 0.0, East = 0.0, Down = 0.0;
+	for (uint N = 1; N <= Degree; N++)
+	{
+		RatioPower *= Ratio;
+		for (uint M = 0; M <= N; M++)
+		{
+			const uint I = N * Stride + M;
+			const double Gt = G[I] + Dt * GDot[I];
+			const double Ht = H[I] + Dt * HDot[I];
+			const double Cosine = Gt * CosM[M] + Ht * SinM[M];
+			const double Sine = Gt * SinM[M] - Ht * CosM[M];
+
+			North += RatioPower * Cosine * Schmidt[I] * DLegendre[I];
+			East += RatioPower * M * Sine * Schmidt[I] * Legendre[I];
+			Down -= RatioPower * (N + 1) * Cosine * Schmidt[I] * Legendre[I];
+		}
+	}
+	East /= S;
+
+	// Back from the geocentric sphere to the ellipsoid
+	const double Psi = GeocentricLatitude - Latitude;
+	Field.North = North * std::cos(Psi) - Down * std::sin(Psi);
+	Field.East = East;
+	Field.Down = North * std::sin(Psi) + Down * std::cos(Psi);
+	return Field;
+}
+
+float MagneticModel::Declination(double LatitudeDegrees, double LongitudeDegrees, double AltitudeKm, double DecimalYear) const
+{
+	const MagneticField Field = Evaluate(LatitudeDegrees, LongitudeDegrees, AltitudeKm, DecimalYear);
+	return float(std::atan2(Field.East, Field.North) / DegreesToRadians);
+}
+
+double MagneticModel::DecimalYearNow()
+{
+	const std::time_t Now = std::time(nullptr);
+	std::tm Utc;
+#ifdef _WIN32
+	gmtime_s(&Utc, &Now);
+#else
+	gmtime_r(&Now, &Utc);
+#endif
+	const int Year = Utc.tm_year + 1900;
+	const bool Leap = (Year % 4 == 0 && Year % 100 != 0) || Year % 400 == 0;
+	return Year + (Utc.tm_yday + Utc.tm_hour / 24.0) / (Leap ? 366.0 : 365.0);
+}
+// End- MagneticModel
+
+// Begin- DeclinationGrid
+bool DeclinationGrid::Build(const MagneticModel& Model, double DecimalYear, float StepDegrees, const std::string& Path, ThreadPool* Pool)
+{
+	if (!Model.IsLoaded() || StepDegrees <= 0.f || StepDegrees > 90.f)
+	{
+		ASSERTNOENTRY("Invalid declination grid!");
+		return false;
+	}
+
+	GridHeader Header;
+	std::memcpy(Header.Magic, GridMagic, sizeof(GridMagic));
+	Header.Version = GridVersion;
+	Header.Rows = uint32_t(std::lround(180.f / StepDegrees)) + 1;
+	Header.Columns = uint32_t(std::lround(360.f / StepDegrees)) + 1;
+	Header.Step = StepDegrees;
+	Header.Reserved = 0;
+	Header.DecimalYear = DecimalYear;
+	Header.ModelEpoch = Model.GetEpoch();
+
+	std::vector<float> Values(size_t(Header.Rows) * Header.Columns);
+	auto BuildRow = [&Model, &Values, &Header, DecimalYear](uint Row)
+	{
+		const double Latitude = -90.0 + Row * double(Header.Step);
+		for (uint Column = 0; Column < Header.Columns; Column++)
+		{
+			Values[size_t(Row) * Header.Columns + Column] = Model.Declination(Latitude, -180.0 + Column * double(Header.Step), 0.0, DecimalYear);
+		}
+	};
+
+	for (uint Row = 0; Row < Header.Rows; Row++)
+	{
+		if (Pool)
+		{
+			Pool->Submit([&BuildRow, Row]() { BuildRow(Row); });
+		}
+		else
+		{
+			BuildRow(Row);
+		}
+	}
+	if (Pool)
+	{
+		Pool->Wait();
+	}
+
+	std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		std::cout << "Could not write declination grid: " << Path << std::endl;
+		return false;
+	}
+	Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	Stream.write(reinterpret_cast<const char*>(Values.data()), Values.size() * sizeof(float));
+	return Stream.good();
+}
+
+bool DeclinationGrid::Open(const std::string& Path)
+{
+	Close();
+	if (!File.Open(Path))
+	{
+		return false;
+	}
+
+	GridHeader Header;
+	if (File.GetSize() < sizeof(Header))
+	{
+		File.Close();
+		return false;
+	}
+	std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+	const size_t ExpectedSize = sizeof(Header) + size_t(Header.Rows) * Header.Columns * sizeof(float);
+	if (std::memcmp(Header.Magic, GridMagic, sizeof(GridMagic)) != 0 || Header.Version != GridVersion
+		|| Header.Rows < 2 || Header.Columns < 2 || File.GetSize() != ExpectedSize)
+	{
+		std::cout << "Not a declination grid: " << Path << std::endl;
+		File.Close();
+		return false;
+	}
+
+	Values = reinterpret_cast<const float*>(File.GetData() + sizeof(Header));
+	Rows = Header.Rows;
+	Columns = Header.Columns;
+	Step = Header.Step;
+	InvStep = 1.f / Header.Step;
+	DecimalYear = Header.DecimalYear;
+	ModelEpoch = Header.ModelEpoch;
+	return true;
+}
+
+void DeclinationGrid::Close()
+{
+	File.Close();
+	Values = nullptr;
+	Rows = Columns = 0;
+}
+
+float DeclinationGrid::Lookup(float LatitudeDegrees, float LongitudeDegrees) const
+{
+	if (!Values)
+	{
+		return 0.f;
+	}
+
+	const float Y = (std::min(std::max(LatitudeDegrees, -90.f), 90.f) + 90.f) * InvStep;
+	const float WrappedLongitude = LongitudeDegrees < -180.f || LongitudeDegrees > 180.f ? HeadingMath::Wrap360(LongitudeDegrees + 180.f) - 180.f : LongitudeDegrees;
+	const float X = (WrappedLongitude + 180.f) * InvStep;
+	const uint Row = std::min(uint(Y), Rows - 2);
+	const uint Column = std::min(uint(X), Columns - 2);
+	const float Ty = Y - Row;
+	const float Tx = X - Column;
+
+	const float* Cell = Values + size_t(Row) * Columns + Column;
+	float V00 = Cell[0], V01 = Cell[1], V10 = Cell[Columns], V11 = Cell[Columns + 1];
+
+	// Declination swings through +-180 near the magnetic poles, so blend offsets from one corner there
+	const float Spread = std::max(std::max(V00, V01), std::max(V10, V11)) - std::min(std::min(V00, V01), std::min(V10, V11));
+	if (Spread > 180.f)
+	{
+		V01 = V00 + HeadingMath::ShortestArc(V00, V01);
+		V10 = V00 + HeadingMath::ShortestArc(V00, V10);
+		V11 = V00 + HeadingMath::ShortestArc(V00, V11);
+	}
+
+	const float Top = V00 + (V01 - V00) * Tx;
+	const float Bottom = V10 + (V11 - V10) * Tx;
+	const float Declination = Top + (Bottom - Top) * Ty;
+	return Declination > 180.f ? Declination - 360.f : (Declination <= -180.f ? Declination + 360.f : Declination);
+}
+
+void DeclinationGrid::MagneticToTrue(const float* Latitudes, const float* Longitudes, const float* InMagnetic, float* OutTrue, uint Count) const
+{
+	for (uint i = 0; i < Count; i++)
+	{
+		// Magnetic headings are already in [0, 360) and declinations in (-180, 180]
+		const float True = InMagnetic[i] + Lookup(Latitudes[i], Longitudes[i]);
+		OutTrue[i] = True < 0.f ? True + 360.f : (True >= 360.f ? True - 360.f : True);
+	}
+}
+// End- DeclinationGrid
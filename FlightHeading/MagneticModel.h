@@ -0,0 +1,79 @@
+#pragma once
+#include "Core.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Field components in nanotesla, geodetic north/east/down
+struct MagneticField
+{
+	double North = 0.0;
+	double East = 0.0;
+	double Down = 0.0;
+};
+
+// Spherical harmonic main field model in the World Magnetic Model coefficient format (WMM.COF:
+// epoch header, then "n m g h gdot hdot" lines). Evaluating degree 12 costs a few microseconds,
+// so per-target conversions go through DeclinationGrid instead.
+class MagneticModel
+{
+public:
+	static constexpr uint MaxDegree = 12;
+
+	MagneticModel() : MagneticModel(0.0) {}
+	explicit MagneticModel(double InEpoch);
+
+	bool Load(const std::string& Path);
+	void SetCoefficient(uint N, uint M, double G, double H, double GDot, double HDot);
+
+	inline bool IsLoaded() const { return Degree > 0; }
+	inline double GetEpoch() const { return Epoch; }
+	inline const std::string& GetName() const { return Name; }
+
+	MagneticField Evaluate(double LatitudeDegrees, double LongitudeDegrees, double AltitudeKm, double DecimalYear) const;
+	// Degrees, east positive: true heading = magnetic heading + declination
+	float Declination(double LatitudeDegrees, double LongitudeDegrees, double AltitudeKm, double DecimalYear) const;
+
+	static double DecimalYearNow();
+
+private:
+	double Epoch = 0.0;
+	std::string Name;
+	uint Degree = 0;
+	// Indexed [N * (MaxDegree + 1) + M]
+	std::vector<double> G, H, GDot, HDot;
+};
+
+// Declination precomputed on a regular latitude/longitude grid and stored in a file that is
+// memory mapped for lookups. A lookup is a bilinear blend of four grid points, tens of nanoseconds
+// instead of microseconds, so thousands of targets can be converted every tick.
+class DeclinationGrid
+{
+public:
+	// Evaluates Model for DecimalYear at sea level every StepDegrees and writes the grid to Path
+	static bool Build(const MagneticModel& Model, double DecimalYear, float StepDegrees, const std::string& Path, ThreadPool* Pool = nullptr);
+
+	bool Open(const std::string& Path);
+	void Close();
+
+	inline bool IsOpen() const { return Values != nullptr; }
+	inline double GetDecimalYear() const { return DecimalYear; }
+	inline double GetModelEpoch() const { return ModelEpoch; }
+
+	// Degrees, east positive
+	float Lookup(float LatitudeDegrees, float LongitudeDegrees) const;
+	// OutTrue[i] = InMagnetic[i] + declination at (Latitudes[i], Longitudes[i]); magnetic headings in [0, 360)
+	void MagneticToTrue(const float* Latitudes, const float* Longitudes, const float* InMagnetic, float* OutTrue, uint Count) const;
+
+private:
+	MappedFile File;
+	const float* Values = nullptr;
+	uint Rows = 0;     // Latitude -90 to 90
+	uint Columns = 0;  // Longitude -180 to 180, both ends stored so lookups never wrap
+	float Step = 1.f;
+	float InvStep = 1.f;
+	double DecimalYear = 0.0;
+	double ModelEpoch = 0.0;
+};
@@ -1,11 +1,49 @@
 #include "Application.h"
+#include "Trace.h"
+#include <cstring>
 
-int main()
+// Usage: FlightHeading [--trace Path] [--render-thread] [--bake-fonts]. --trace records a timeline from
+// startup until exit, --render-thread starts with GL on its own thread (also switchable in the Control
+// Panel), --bake-fonts only rebuilds the UI font atlas from res/fonts/Fonts.cfg and exits.
+int main(int argc, char** argv)
 {
+	const char* TracePath = nullptr;
+	bool RenderThread = false;
+	bool BakeFonts = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			TracePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--render-thread") == 0)
+		{
+			RenderThread = true;
+		}
+		else if (std::strcmp(argv[i], "--bake-fonts") == 0)
+		{
+			BakeFonts = true;
+		}
+	}
+	if (BakeFonts)
+	{
+		return Application::BakeFonts() ? 0 : 1;
+	}
+	if (TracePath)
+	{
+		Trace::Start();
+	}
+
 	{
 		Application App;
+		App.SetRenderThread(RenderThread);
 		App.Run();
 	}
 
+	if (TracePath && Trace::IsRecording())
+	{
+		Trace::Stop(TracePath);
+	}
+
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& Path)
+{
+	Open(Path);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& Path)
+{
+	Close();
+
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open file: " << Path << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+	{
+		CloseHandle(File);
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* View = Mapping ? MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!View)
+	{
+		std::cout << "Could not map file: " << Path << std::endl;
+		if (Mapping)
+		{
+			CloseHandle(Mapping);
+		}
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Data = static_cast<const uchar*>(View);
+	Size = size_t(FileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+		CloseHandle(MappingHandle);
+		CloseHandle(FileHandle);
+	}
+	Data = nullptr;
+	Size = 0;
+	FileHandle = nullptr;
+	MappingHandle = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string& Path)
+{
+	Close();
+
+	const int Fd = open(Path.c_str(), O_RDONLY);
+	if (Fd < 0)
+	{
+		std::cout << "Could not open file: " << Path << std::endl;
+		return false;
+	}
+
+	struct stat Stat;
+	if (fstat(Fd, &Stat) != 0 || Stat.st_size == 0)
+	{
+		close(Fd);
+		return false;
+	}
+
+	void* View = mmap(nullptr, size_t(Stat.st_size), PROT_READ, MAP_PRIVATE, Fd, 0);
+	if (View == MAP_FAILED)
+	{
+		std::cout << "Could not map file: " << Path << std::endl;
+		close(Fd);
+		return false;
+	}
+	madvise(View, size_t(Stat.st_size), MADV_SEQUENTIAL);
+
+	FileDescriptor = Fd;
+	Data = static_cast<const uchar*>(View);
+	Size = size_t(Stat.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		munmap(const_cast<uchar*>(Data), Size);
+		close(FileDescriptor);
+	}
+	Data = nullptr;
+	Size = 0;
+	FileDescriptor = -1;
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include "Core.h"
+#include <string>
+
+// Read-only memory mapping of a whole file
+class MappedFile : public Useful::NonCopyable
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& Path);
+	~MappedFile();
+
+	bool Open(const std::string& Path);
+	void Close();
+
+	inline bool IsOpen() const { return Data != nullptr; }
+	inline const uchar* GetData() const { return Data; }
+	inline size_t GetSize() const { return Size; }
+
+private:
+	const uchar* Data = nullptr;
+	size_t Size = 0;
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#else
+	int FileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,322 @@
+#include "PngWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	const std::array<uint32_t, 256>& CrcTable()
+	{
+		static const std::array<uint32_t, 256> Table = []()
+		{
+			std::array<uint32_t, 256> Result;
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				Result[n] = c;
+			}
+			return Result;
+		}();
+		return Table;
+	}
+
+	uint32_t Crc32(const uchar* Data, size_t Size, uint32_t Crc = 0xFFFFFFFFu)
+	{
+		const std::array<uint32_t, 256>& Table = CrcTable();
+		for (size_t i = 0; i < Size; i++)
+		{
+			Crc = Table[(Crc ^ Data[i]) & 0xFF] ^ (Crc >> 8);
+		}
+		return Crc;
+	}
+
+	uint32_t Adler32(const uchar* Data, size_t Size)
+	{
+		uint32_t A = 1, B = 0;
+		while (Size > 0)
+		{
+			// Largest run that cannot overflow before the modulo
+			const size_t Run = std::min<size_t>(Size, 5552);
+			for (size_t i = 0; i < Run; i++)
+			{
+				A += Data[i];
+				B += A;
+			}
+			A %= 65521;
+			B %= 65521;
+			Data += Run;
+			Size -= Run;
+		}
+		return (B << 16) | A;
+	}
+
+	void PutBigEndian(std::vector<uchar>& Out, uint32_t Value)
+	{
+		Out.push_back(uchar(Value >> 24));
+		Out.push_back(uchar(Value >> 16));
+		Out.push_back(uchar(Value >> 8));
+		Out.push_back(uchar(Value));
+	}
+
+	void PutChunk(std::vector<uchar>& Out, const char* Type, const uchar* Data, size_t Size)
+	{
+		PutBigEndian(Out, uint32_t(Size));
+		const size_t TypeOffset = Out.size();
+		Out.insert(Out.end(), Type, Type + 4);
+		Out.insert(Out.end(), Data, Data + Size);
+		PutBigEndian(Out, Crc32(Out.data() + TypeOffset, Size + 4) ^ 0xFFFFFFFFu);
+	}
+
+	struct DeflateWriter
+	{
+		std::vector<uchar>& Out;
+		uint64_t Acc = 0;
+		uint BitCount = 0;
+
+		explicit DeflateWriter(std::vector<uchar>& InOut) : Out(InOut) {}
+
+		inline void Bits(uint32_t Value, uint Count)
+		{
+			Acc |= uint64_t(Value) << BitCount;
+			BitCount += Count;
+			while (BitCount >= 8)
+			{
+				Out.push_back(uchar(Acc));
+				Acc >>= 8;
+				BitCount -= 8;
+			}
+		}
+
+		// Huffman codes go out most significant bit first
+		inline void Code(uint32_t Value, uint Count)
+		{
+			uint32_t Reversed = 0;
+			for (uint i = 0; i < Count; i++)
+			{
+				Reversed = (Reversed << 1) | ((Value >> i) & 1);
+			}
+			Bits(Reversed, Count);
+		}
+
+		// Fixed Huffman literal/length alphabet
+		inline void Symbol(uint Value)
+		{
+			if (Value < 144)
+			{
+				Code(0x30 + Value, 8);
+			}
+			else if (Value < 256)
+			{
+				Code(0x190 + Value - 144, 9);
+			}
+			else if (Value < 280)
+			{
+				Code(Value - 256, 7);
+			}
+			else
+			{
+				Code(0xC0 + Value - 280, 8);
+			}
+		}
+
+		void Flush()
+		{
+			if (BitCount > 0)
+			{
+				Out.push_back(uchar(Acc));
+			}
+			Acc = 0;
+			BitCount = 0;
+		}
+	};
+
+	const uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uchar LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uchar DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	void Deflate(const uchar* Data, size_t Size, std::vector<uchar>& Out)
+	{
+		constexpr uint HashBits = 15;
+		constexpr size_t WindowSize = 32768;
+		constexpr uint MinMatch = 3;
+		constexpr uint MaxMatch = 258;
+
+		std::vector<int32_t> Head(size_t(1) << HashBits, -1);
+		auto Hash = [Data](size_t Pos)
+		{
+			const uint32_t Word = uint32_t(Data[Pos]) | (uint32_t(Data[Pos + 1]) << 8) | (uint32_t(Data[Pos + 2]) << 16);
+			return (Word * 2654435761u) >> (32 - HashBits);
+		};
+
+		DeflateWriter Writer(Out);
+		Writer.Bits(1, 1); // BFINAL
+		Writer.Bits(1, 2); // Fixed Huffman
+
+		size_t Pos = 0;
+		while (Pos < Size)
+		{
+			uint Length = 0;
+			size_t Distance = 0;
+
+			if (Pos + MinMatch <= Size)
+			{
+				const uint32_t Slot = Hash(Pos);
+				const int32_t Candidate = Head[Slot];
+				Head[Slot] = int32_t(Pos);
+
+				if (Candidate >= 0 && Pos - Candidate <= WindowSize)
+				{
+					const uint Limit = uint(std::min<size_t>(MaxMatch, Size - Pos));
+					while (Length < Limit && Data[Candidate + Length] == Data[Pos + Length])
+					{
+						Length++;
+					}
+					Distance = Pos - Candidate;
+				}
+			}
+
+			if (Length < MinMatch)
+			{
+				Writer.Symbol(Data[Pos]);
+				Pos++;
+				continue;
+			}
+
+			const uint LengthCode = uint(std::upper_bound(LengthBase, LengthBase + 29, Length) - LengthBase) - 1;
+			Writer.Symbol(257 + LengthCode);
+			Writer.Bits(Length - LengthBase[LengthCode], LengthExtra[LengthCode]);
+
+			const uint DistanceCode = uint(std::upper_bound(DistanceBase, DistanceBase + 30, Distance) - DistanceBase) - 1;
+			Writer.Code(DistanceCode, 5);
+			Writer.Bits(uint32_t(Distance - DistanceBase[DistanceCode]), DistanceExtra[DistanceCode]);
+
+			for (size_t Skip = Pos + 1; Skip < Pos + Length && Skip + MinMatch <= Size; Skip++)
+			{
+				Head[Hash(Skip)] = int32_t(Skip);
+			}
+			Pos += Length;
+		}
+
+		Writer.Symbol(256);
+		Writer.Flush();
+	}
+
+	inline uchar Paeth(int A, int B, int C)
+	{
+		const int P = A + B - C;
+		const int PA = std::abs(P - A), PB = std::abs(P - B), PC = std::abs(P - C);
+		if (PA <= PB && PA <= PC)
+		{
+			return uchar(A);
+		}
+		return uchar(PB <= PC ? B : C);
+	}
+}
+
+bool PngWriter::Encode(const uchar* Pixels, uint Width, uint Height, uint Channels, bool FlipY, std::vector<uchar>& OutPng)
+{
+	if (!Pixels || Width == 0 || Height == 0 || (Channels != 3 && Channels != 4))
+	{
+		ASSERTNOENTRY("Unsupported PNG layout!");
+		return false;
+	}
+
+	const size_t Stride = size_t(Width) * Channels;
+	std::vector<uchar> Filtered((Stride + 1) * Height);
+	std::vector<uchar> Candidate[5];
+	for (std::vector<uchar>& Row : Candidate)
+	{
+		Row.resize(Stride);
+	}
+
+	for (uint y = 0; y < Height; y++)
+	{
+		const uchar* Row = Pixels + Stride * (FlipY ? Height - 1 - y : y);
+		const uchar* Prior = y == 0 ? nullptr : Pixels + Stride * (FlipY ? Height - y : y - 1);
+
+		// Pick the filter with the smallest sum of absolute residuals
+		uint BestFilter = 0;
+		uint64_t BestScore = UINT64_MAX;
+		for (uint Filter = 0; Filter < 5; Filter++)
+		{
+			uint64_t Score = 0;
+			for (size_t i = 0; i < Stride; i++)
+			{
+				const int Left = i >= Channels ? Row[i - Channels] : 0;
+				const int Up = Prior ? Prior[i] : 0;
+				const int UpLeft = Prior && i >= Channels ? Prior[i - Channels] : 0;
+
+				uchar Predicted = 0;
+				switch (Filter)
+				{
+				case 1: Predicted = uchar(Left); break;
+				case 2: Predicted = uchar(Up); break;
+				case 3: Predicted = uchar((Left + Up) / 2); break;
+				case 4: Predicted = Paeth(Left, Up, UpLeft); break;
+				default: break;
+				}
+
+				const uchar Residual = uchar(Row[i] - Predicted);
+				Candidate[Filter][i] = Residual;
+				Score += Residual < 128 ? Residual : 256 - Residual;
+			}
+
+			if (Score < BestScore)
+			{
+				BestScore = Score;
+				BestFilter = Filter;
+			}
+		}
+
+		uchar* Out = Filtered.data() + (Stride + 1) * y;
+		Out[0] = uchar(BestFilter);
+		std::memcpy(Out + 1, Candidate[BestFilter].data(), Stride);
+	}
+
+	std::vector<uchar> Compressed = { 0x78, 0x01 };
+	Deflate(Filtered.data(), Filtered.size(), Compressed);
+	PutBigEndian(Compressed, Adler32(Filtered.data(), Filtered.size()));
+
+	static const uchar Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	OutPng.assign(Signature, Signature + 8);
+
+	std::vector<uchar> Header;
+	PutBigEndian(Header, Width);
+	PutBigEndian(Header, Height);
+	Header.push_back(8);                      // Bit depth
+	Header.push_back(Channels == 4 ? 6 : 2);  // RGBA or RGB
+	Header.push_back(0);                      // Deflate
+	Header.push_back(0);                      // Adaptive filtering
+	Header.push_back(0);                      // No interlace
+
+	PutChunk(OutPng, "IHDR", Header.data(), Header.size());
+	PutChunk(OutPng, "IDAT", Compressed.data(), Compressed.size());
+	PutChunk(OutPng, "IEND", nullptr, 0);
+	return true;
+}
+
+bool PngWriter::Write(const std::string& Path, const uchar* Pixels, uint Width, uint Height, uint Channels, bool FlipY)
+{
+	std::vector<uchar> Png;
+	if (!Encode(Pixels, Width, Height, Channels, FlipY, Png))
+	{
+		return false;
+	}
+
+	std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		std::cout << "Could not write PNG: " << Path << std::endl;
+		return false;
+	}
+	Stream.write(reinterpret_cast<const char*>(Png.data()), Png.size());
+	return Stream.good();
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Core.h"
+#include <string>
+#include <vector>
+
+// Self-contained PNG encoder (8-bit RGB/RGBA). Rows get the usual adaptive filter choice and the
+// image data is deflated with fixed Huffman codes and a single-probe LZ77 matcher, which keeps
+// encoding fast while still shrinking the large flat areas of instrument artwork well.
+namespace PngWriter
+{
+	// Pixels are tightly packed rows of Width * Channels bytes. FlipY writes bottom-up input
+	// (as returned by glReadPixels) top-down.
+	bool Encode(const uchar* Pixels, uint Width, uint Height, uint Channels, bool FlipY, std::vector<uchar>& OutPng);
+	bool Write(const std::string& Path, const uchar* Pixels, uint Width, uint Height, uint Channels, bool FlipY);
+}
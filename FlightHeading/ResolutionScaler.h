@@ -0,0 +1,74 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Picks the render scale of the gauge pass from measured GPU frame times. Fill cost goes with the pixel
+// count, the square of the scale, so a frame over budget drops by the square root of the overshoot
+// at once, while headroom only grows the scale a step at a time. After every change it waits out the
+// frames still in flight at the old scale before measuring again, so it does not hunt.
+class ResolutionScaler
+{
+public:
+	float TargetMs = 14.f;  // GPU time a frame should stay under
+	float MinScale = 0.5f;
+	float MaxScale = 1.f;
+
+	inline void Reset(float InScale = 1.f)
+	{
+		Scale = std::min(std::max(InScale, MinScale), MaxScale);
+		SmoothedMs = 0.f;
+		Samples = 0;
+		Cooldown = 0;
+	}
+
+	// Feeds one measured GPU frame and returns the scale to render the next ones at
+	inline float Update(float GpuMs)
+	{
+		if (Cooldown > 0)
+		{
+			Cooldown--;
+			return Scale;
+		}
+
+		SmoothedMs = Samples == 0 ? GpuMs : SmoothedMs + (GpuMs - SmoothedMs) * Smoothing;
+		if (++Samples < MinSamples)
+		{
+			return Scale;
+		}
+
+		float NewScale = Scale;
+		if (SmoothedMs > TargetMs)
+		{
+			NewScale = Scale * std::sqrt(TargetMs * Headroom / SmoothedMs);
+		}
+		else if (SmoothedMs < TargetMs * Headroom)
+		{
+			NewScale = Scale + GrowStep;
+		}
+		NewScale = std::min(std::max(NewScale, MinScale), MaxScale);
+
+		if (std::fabs(NewScale - Scale) > 0.001f)
+		{
+			Scale = NewScale;
+			SmoothedMs = 0.f;
+			Samples = 0;
+			Cooldown = SettleFrames;
+		}
+		return Scale;
+	}
+
+	inline float GetScale() const { return Scale; }
+	inline float GetSmoothedMs() const { return SmoothedMs; }
+
+private:
+	static constexpr float Smoothing = 0.25f;
+	static constexpr float Headroom = 0.85f; // Grows only below this fraction of the target
+	static constexpr float GrowStep = 0.05f;
+	static constexpr int MinSamples = 4;
+	static constexpr int SettleFrames = 4;   // More than the timer's latency
+
+	float Scale = 1.f;
+	float SmoothedMs = 0.f;
+	int Samples = 0;
+	int Cooldown = 0;
+};
@@ -0,0 +1,172 @@
+#include "ResourceMemory.h"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	struct Record
+	{
+		ResourceMemory::Entry Info;
+		std::function<void()> OnEvict;
+	};
+
+	std::mutex Mutex;
+	std::unordered_map<uint, Record> Records;
+	uint NextId = 1;
+	uint64_t Frame = 1;
+	size_t Budget = 0;
+	uint Evictions = 0;
+
+	size_t GpuTotal()
+	{
+		size_t Total = 0;
+		for (const auto& Pair : Records)
+		{
+			Total += Pair.second.Info.Resident ? Pair.second.Info.GpuBytes : 0;
+		}
+		return Total;
+	}
+}
+
+uint ResourceMemory::Register(Kind Type, const std::string& Name, std::function<void()> OnEvict)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	const uint Id = NextId++;
+	Record& New = Records[Id];
+	New.Info.Name = Name;
+	New.Info.Type = Type;
+	New.Info.LastUsedFrame = Frame;
+	New.Info.Evictable = OnEvict != nullptr;
+	New.OnEvict = std::move(OnEvict);
+	return Id;
+}
+
+void ResourceMemory::Unregister(uint Id)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Records.erase(Id);
+}
+
+void ResourceMemory::SetBytes(uint Id, size_t GpuBytes, size_t CpuBytes)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	auto Found = Records.find(Id);
+	if (Found == Records.end())
+	{
+		return;
+	}
+
+	Found->second.Info.GpuBytes = GpuBytes;
+	Found->second.Info.CpuBytes = CpuBytes;
+	Found->second.Info.Resident = true;
+}
+
+void ResourceMemory::Touch(uint Id)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	auto Found = Records.find(Id);
+	if (Found != Records.end())
+	{
+		Found->second.Info.LastUsedFrame = Frame;
+	}
+}
+
+void ResourceMemory::EndFrame()
+{
+	// Callbacks delete GL objects and may come back in here, so they run after the lock is released
+	std::vector<std::function<void()>> Victims;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		size_t Total = GpuTotal();
+		if (Budget > 0 && Total > Budget)
+		{
+			std::vector<Record*> Candidates;
+			for (auto& Pair : Records)
+			{
+				const ResourceMemory::Entry& Info = Pair.second.Info;
+				if (Info.Evictable && Info.Resident && Info.LastUsedFrame < Frame)
+				{
+					Candidates.push_back(&Pair.second);
+				}
+			}
+			std::sort(Candidates.begin(), Candidates.end(), [](const Record* A, const Record* B) { return A->Info.LastUsedFrame < B->Info.LastUsedFrame; });
+
+			for (Record* Candidate : Candidates)
+			{
+				if (Total <= Budget)
+				{
+					break;
+				}
+				Total -= Candidate->Info.GpuBytes;
+				Candidate->Info.Resident = false;
+				Victims.push_back(Candidate->OnEvict);
+				Evictions++;
+			}
+		}
+		Frame++;
+	}
+
+	for (const auto& Evict : Victims)
+	{
+		Evict();
+	}
+}
+
+void ResourceMemory::SetBudget(size_t Bytes)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Budget = Bytes;
+}
+
+ResourceMemory::Totals ResourceMemory::GetTotals()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Totals Out;
+	Out.BudgetBytes = Budget;
+	Out.Evictions = Evictions;
+	for (const auto& Pair : Records)
+	{
+		const Entry& Info = Pair.second.Info;
+		Out.CpuBytes += Info.CpuBytes;
+		if (!Info.Resident)
+		{
+			Out.Evicted++;
+			continue;
+		}
+		Out.Resident++;
+		(Info.Type == Kind::Texture ? Out.TextureBytes : Out.BufferBytes) += Info.GpuBytes;
+	}
+	return Out;
+}
+
+std::vector<ResourceMemory::Entry> ResourceMemory::GetEntries()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	std::vector<Entry> Out;
+	Out.reserve(Records.size());
+	for (const auto& Pair : Records)
+	{
+		Out.push_back(Pair.second.Info);
+	}
+	std::sort(Out.begin(), Out.end(), [](const Entry& A, const Entry& B) { return A.GpuBytes > B.GpuBytes; });
+	return Out;
+}
+
+uint64_t ResourceMemory::GetFrame()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	return Frame;
+}
+
+size_t ResourceMemory::TextureBytes(uint Width, uint Height, uint BytesPerTexel, bool Mipmapped)
+{
+	size_t Total = size_t(Width) * Height * BytesPerTexel;
+	while (Mipmapped && (Width > 1 || Height > 1))
+	{
+		Width = std::max(Width / 2, 1u);
+		Height = std::max(Height / 2, 1u);
+		Total += size_t(Width) * Height * BytesPerTexel;
+	}
+	return Total;
+}
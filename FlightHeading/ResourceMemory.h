@@ -0,0 +1,63 @@
+#pragma once
+#include "Core.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Estimated memory held by GPU resources and by the CPU copies kept for them. Sizes are what the
+// upload asked for, drivers may pad or compress. Evictable resources are released least recently
+// used first whenever GPU memory is over budget at the end of a frame; anything used during that
+// frame is visible and stays. Call from the thread that owns the GL context.
+namespace ResourceMemory
+{
+	enum class Kind
+	{
+		Texture,
+		Buffer
+	};
+
+	struct Totals
+	{
+		size_t TextureBytes = 0;
+		size_t BufferBytes = 0;
+		size_t CpuBytes = 0;
+		size_t BudgetBytes = 0;
+		uint Resident = 0;
+		uint Evicted = 0;
+		uint Evictions = 0; // Since startup
+	};
+
+	struct Entry
+	{
+		std::string Name;
+		Kind Type = Kind::Texture;
+		size_t GpuBytes = 0;
+		size_t CpuBytes = 0;
+		uint64_t LastUsedFrame = 0;
+		bool Resident = true;
+		bool Evictable = false;
+	};
+
+	// OnEvict releases the GPU object; the resource restores itself when next used. Without one the
+	// resource is only counted.
+	uint Register(Kind Type, const std::string& Name, std::function<void()> OnEvict = nullptr);
+	void Unregister(uint Id);
+	// Also marks the resource resident again after an eviction
+	void SetBytes(uint Id, size_t GpuBytes, size_t CpuBytes = 0);
+	// Marks the resource as used in the current frame
+	void Touch(uint Id);
+
+	// Evicts down to the budget and starts the next frame
+	void EndFrame();
+	// 0 disables eviction
+	void SetBudget(size_t Bytes);
+
+	Totals GetTotals();
+	std::vector<Entry> GetEntries();
+	uint64_t GetFrame();
+
+	// Bytes of a 2D texture, with every mip level down to 1x1 when Mipmapped
+	size_t TextureBytes(uint Width, uint Height, uint BytesPerTexel, bool Mipmapped);
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "Core.h"
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Slot index plus generation. A slot gets a new generation whenever its resource is destroyed, so a
+// handle that outlived its resource fails the lookup instead of reaching whatever reused the slot.
+template<typename T>
+struct ResourceHandle
+{
+	uint Index = 0;
+	uint Generation = 0; // Never issued, so a default handle is invalid
+
+	inline bool IsValid() const { return Generation != 0; }
+	inline bool operator==(const ResourceHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	inline bool operator!=(const ResourceHandle& Other) const { return !(*this == Other); }
+};
+
+// Resources constructed in place in fixed size chunks: they never move once created, and a lookup
+// is an array index and a generation compare. Slots of destroyed resources are reused.
+template<typename T, uint ChunkSize = 64>
+class ResourcePool : public Useful::NonCopyable
+{
+public:
+	using Handle = ResourceHandle<T>;
+
+	ResourcePool() = default;
+	~ResourcePool() { Clear(); }
+
+	template<typename... ArgTypes>
+	Handle Create(ArgTypes&&... Args)
+	{
+		uint Index;
+		if (!FreeSlots.empty())
+		{
+			Index = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+		else
+		{
+			Index = SlotCount++;
+			if (Index / ChunkSize >= Chunks.size())
+			{
+				Chunks.emplace_back(new Slot[ChunkSize]);
+			}
+		}
+
+		Slot& Target = GetSlot(Index);
+		new (Target.Storage) T(std::forward<ArgTypes>(Args)...);
+		Target.Alive = true;
+		LiveCount++;
+		return { Index, Target.Generation };
+	}
+
+	// Null for stale or invalid handles
+	inline T* Get(Handle InHandle)
+	{
+		if (InHandle.Index >= SlotCount)
+		{
+			return nullptr;
+		}
+		Slot& Target = GetSlot(InHandle.Index);
+		return Target.Alive && Target.Generation == InHandle.Generation ? Target.Get() : nullptr;
+	}
+
+	bool Destroy(Handle InHandle)
+	{
+		T* Object = Get(InHandle);
+		if (!Object)
+		{
+			return false;
+		}
+
+		Object->~T();
+		Slot& Target = GetSlot(InHandle.Index);
+		Target.Alive = false;
+		Target.Generation = Target.Generation + 1 == 0 ? 1 : Target.Generation + 1;
+		FreeSlots.push_back(InHandle.Index);
+		LiveCount--;
+		return true;
+	}
+
+	void Clear()
+	{
+		for (uint Index = 0; Index < SlotCount; Index++)
+		{
+			Slot& Target = GetSlot(Index);
+			if (Target.Alive)
+			{
+				Destroy({ Index, Target.Generation });
+			}
+		}
+	}
+
+	inline uint GetLiveCount() const { return LiveCount; }
+
+private:
+	struct Slot
+	{
+		alignas(T) uchar Storage[sizeof(T)];
+		uint Generation = 1;
+		bool Alive = false;
+
+		inline T* Get() { return reinterpret_cast<T*>(Storage); }
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> Chunks;
+	std::vector<uint> FreeSlots;
+	uint SlotCount = 0; // Slots handed out at least once
+	uint LiveCount = 0;
+
+	inline Slot& GetSlot(uint Index) { return Chunks[Index / ChunkSize][Index % ChunkSize]; }
+};
@@ -0,0 +1,156 @@
+#include "ResourceRegistry.h"
+#include "Trace.h"
+#include <algorithm>
+
+ResourceRegistry::~ResourceRegistry()
+{
+	Loader.Wait();
+	DiscardReloads();
+}
+
+TextureHandle ResourceRegistry::LoadTexture(const std::string& Path, bool FlipUV, bool Gamma, GLenum RepeatMode, bool RetainPixels, bool PremultiplyAlpha)
+{
+	const TextureKey Key(Path, FlipUV, Gamma, RepeatMode, RetainPixels, PremultiplyAlpha);
+	const TextureHandle Existing = Textures.Find(Key);
+	if (Existing.IsValid())
+	{
+		return Existing;
+	}
+
+	TRACE_SCOPE("Load texture");
+	return Textures.Add(Key, Path, FlipUV, Gamma, RepeatMode, RetainPixels, PremultiplyAlpha);
+}
+
+ShaderHandle ResourceRegistry::LoadShader(const std::string& VertexPath, const std::string& FragmentPath, std::vector<std::string> Defines)
+{
+	// The same permutation asked for with its defines in another order
+	std::sort(Defines.begin(), Defines.end());
+	const ShaderKey Key(VertexPath, FragmentPath, Defines);
+	const ShaderHandle Existing = Shaders.Find(Key);
+	if (Existing.IsValid())
+	{
+		return Existing;
+	}
+
+	TRACE_SCOPE("Load shader");
+	return Shaders.Add(Key, VertexPath, FragmentPath, Defines);
+}
+
+void ResourceRegistry::Reload(const std::string& Path)
+{
+	for (const auto& Loaded : Textures.Loaded)
+	{
+		if (std::get<0>(Loaded.first) != Path)
+		{
+			continue;
+		}
+
+		const TextureHandle Handle = Loaded.second;
+		const bool FlipUV = std::get<1>(Loaded.first);
+		const bool Gamma = std::get<2>(Loaded.first);
+		const bool PremultiplyAlpha = std::get<5>(Loaded.first);
+		Loader.Submit([this, Handle, Path, FlipUV, Gamma, PremultiplyAlpha]()
+		{
+			TRACE_SCOPE("Decode texture");
+			DecodedImage Image = DecodedImage::Load(Path, FlipUV);
+			if (!Image.Pixels)
+			{
+				std::cout << "Could not decode " << Path << ", keeping the previous texture" << std::endl;
+				return;
+			}
+			if (PremultiplyAlpha)
+			{
+				Image.PremultiplyAlpha(Gamma);
+			}
+
+			std::lock_guard<std::mutex> Lock(ReloadMutex);
+			ReadyTextures.emplace_back(Handle, Image);
+		});
+	}
+
+	for (const auto& Loaded : Shaders.Loaded)
+	{
+		const Shader* Target = Shaders.Pool.Get(Loaded.second);
+		if (!Target || !Target->DependsOn(Path))
+		{
+			continue;
+		}
+
+		ShaderSources Sources;
+		Sources.Handle = Loaded.second;
+		const ShaderKey Key = Loaded.first;
+		Loader.Submit([this, Sources, Key]() mutable
+		{
+			TRACE_SCOPE("Read shader");
+			const std::vector<std::string>& Defines = std::get<2>(Key);
+			if (!ShaderSource::Load(std::get<0>(Key), Defines, Sources.Vertex) || !ShaderSource::Load(std::get<1>(Key), Defines, Sources.Fragment))
+			{
+				std::cout << "Keeping the previous program of " << std::get<0>(Key) << " and " << std::get<1>(Key) << std::endl;
+				return;
+			}
+
+			std::lock_guard<std::mutex> Lock(ReloadMutex);
+			ReadyShaders.push_back(std::move(Sources));
+		});
+	}
+}
+
+uint ResourceRegistry::ApplyReloads()
+{
+	std::vector<std::pair<TextureHandle, DecodedImage>> NewTextures;
+	std::vector<ShaderSources> NewShaders;
+	{
+		std::lock_guard<std::mutex> Lock(ReloadMutex);
+		if (ReadyTextures.empty() && ReadyShaders.empty())
+		{
+			return 0;
+		}
+		NewTextures.swap(ReadyTextures);
+		NewShaders.swap(ReadyShaders);
+	}
+
+	TRACE_SCOPE("ApplyReloads");
+	uint Applied = 0;
+	for (auto& Ready : NewTextures)
+	{
+		// The texture may have been released while its file was decoding
+		if (Texture* Target = Get(Ready.first))
+		{
+			Target->Replace(Ready.second);
+			Applied++;
+		}
+		else
+		{
+			Ready.second.Free();
+		}
+	}
+
+	for (const ShaderSources& Ready : NewShaders)
+	{
+		Shader* Target = Get(Ready.Handle);
+		if (Target && Target->Rebuild(Ready.Vertex, Ready.Fragment))
+		{
+			Applied++;
+		}
+	}
+	return Applied;
+}
+
+void ResourceRegistry::Clear()
+{
+	Loader.Wait();
+	DiscardReloads();
+	Textures.Clear();
+	Shaders.Clear();
+}
+
+void ResourceRegistry::DiscardReloads()
+{
+	std::lock_guard<std::mutex> Lock(ReloadMutex);
+	for (auto& Ready : ReadyTextures)
+	{
+		Ready.second.Free();
+	}
+	ReadyTextures.clear();
+	ReadyShaders.clear();
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "Core.h"
+#include "Helper.h"
+#include "ResourcePool.h"
+#include "ThreadPool.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using TextureHandle = ResourceHandle<Texture>;
+using ShaderHandle = ResourceHandle<Shader>;
+
+// Owns the file backed GPU resources. Loading something that is already loaded with the same
+// parameters returns the existing handle with one more reference instead of decoding and
+// uploading it again; the resource is destroyed with its last Release. Reload reads the files on a
+// background thread and ApplyReloads swaps the results in, so the render loop never waits on disk.
+class ResourceRegistry : public Useful::NonCopyable
+{
+public:
+	ResourceRegistry() = default;
+	~ResourceRegistry();
+
+	TextureHandle LoadTexture(const std::string& Path, bool FlipUV = true, bool Gamma = false, GLenum RepeatMode = GL_REPEAT, bool RetainPixels = false, bool PremultiplyAlpha = false);
+	// Every distinct set of Defines is its own program, built the first time it is asked for
+	ShaderHandle LoadShader(const std::string& VertexPath, const std::string& FragmentPath, std::vector<std::string> Defines = {});
+
+	inline Texture* Get(TextureHandle Handle) { return Textures.Pool.Get(Handle); }
+	inline Shader* Get(ShaderHandle Handle) { return Shaders.Pool.Get(Handle); }
+
+	// For a handle that gets stored a second time
+	inline void Retain(TextureHandle Handle) { Textures.Retain(Handle); }
+	inline void Retain(ShaderHandle Handle) { Shaders.Retain(Handle); }
+	inline void Release(TextureHandle Handle) { Textures.Release(Handle); }
+	inline void Release(ShaderHandle Handle) { Shaders.Release(Handle); }
+
+	inline uint GetTextureCount() const { return Textures.Pool.GetLiveCount(); }
+	inline uint GetShaderCount() const { return Shaders.Pool.GetLiveCount(); }
+
+	// Queues a reload of everything loaded from Path or, for shaders, including it
+	void Reload(const std::string& Path);
+	// Uploads or relinks what finished loading; call between frames. Returns how many were swapped in.
+	uint ApplyReloads();
+
+	// Destroys everything regardless of references, while the GL context is still current
+	void Clear();
+
+private:
+	struct ShaderSources
+	{
+		ShaderHandle Handle;
+		ShaderSource Vertex;
+		ShaderSource Fragment;
+	};
+
+	template<typename T, typename KeyType>
+	struct Cache
+	{
+		ResourcePool<T> Pool;
+		std::map<KeyType, ResourceHandle<T>> Loaded;
+		std::vector<uint> References; // By slot index
+		std::vector<KeyType> Keys;    // By slot index
+
+		// Valid only when Key was loaded before; takes a reference
+		ResourceHandle<T> Find(const KeyType& Key)
+		{
+			auto Found = Loaded.find(Key);
+			if (Found == Loaded.end())
+			{
+				return {};
+			}
+			References[Found->second.Index]++;
+			return Found->second;
+		}
+
+		template<typename... ArgTypes>
+		ResourceHandle<T> Add(const KeyType& Key, ArgTypes&&... Args)
+		{
+			const ResourceHandle<T> Handle = Pool.Create(std::forward<ArgTypes>(Args)...);
+			if (Handle.Index >= References.size())
+			{
+				References.resize(Handle.Index + 1, 0);
+				Keys.resize(Handle.Index + 1);
+			}
+			References[Handle.Index] = 1;
+			Keys[Handle.Index] = Key;
+			Loaded[Key] = Handle;
+			return Handle;
+		}
+
+		void Retain(ResourceHandle<T> Handle)
+		{
+			if (Pool.Get(Handle))
+			{
+				References[Handle.Index]++;
+			}
+		}
+
+		void Release(ResourceHandle<T> Handle)
+		{
+			if (!Pool.Get(Handle) || --References[Handle.Index] > 0)
+			{
+				return;
+			}
+			Loaded.erase(Keys[Handle.Index]);
+			Pool.Destroy(Handle);
+		}
+
+		void Clear()
+		{
+			Loaded.clear();
+			Pool.Clear();
+		}
+	};
+
+	using TextureKey = std::tuple<std::string, bool, bool, GLenum, bool, bool>;
+	using ShaderKey = std::tuple<std::string, std::string, std::vector<std::string>>;
+
+	Cache<Texture, TextureKey> Textures;
+	Cache<Shader, ShaderKey> Shaders;
+
+	std::mutex ReloadMutex;
+	std::vector<std::pair<TextureHandle, DecodedImage>> ReadyTextures;
+	std::vector<ShaderSources> ReadyShaders;
+	ThreadPool Loader{ 1 }; // Last, so its thread is gone before anything it writes to
+
+	void DiscardReloads();
+};
@@ -0,0 +1,103 @@
+#include "ShaderSource.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr uint MaxIncludeDepth = 16;
+
+	std::string DirectoryOf(const std::string& Path)
+	{
+		const size_t Slash = Path.find_last_of("/\\");
+		return Slash == std::string::npos ? std::string() : Path.substr(0, Slash + 1);
+	}
+
+	// The quoted name of an #include line, empty for any other line
+	std::string IncludeName(const std::string& Line)
+	{
+		const size_t Start = Line.find_first_not_of(" \t");
+		if (Start == std::string::npos || Line.compare(Start, 8, "#include") != 0)
+		{
+			return "";
+		}
+		const size_t Open = Line.find('"', Start + 8);
+		const size_t Close = Open == std::string::npos ? Open : Line.find('"', Open + 1);
+		return Close == std::string::npos ? "" : Line.substr(Open + 1, Close - Open - 1);
+	}
+
+	bool IsVersion(const std::string& Line)
+	{
+		const size_t Start = Line.find_first_not_of(" \t");
+		return Start != std::string::npos && Line.compare(Start, 8, "#version") == 0;
+	}
+
+	bool Expand(const std::string& Path, const std::vector<std::string>& Defines, uint Depth, std::ostringstream& Text, std::vector<std::string>& Files)
+	{
+		std::ifstream Stream(Path);
+		if (!Stream.is_open())
+		{
+			std::cout << "Could not open shader file " << Path << std::endl;
+			return false;
+		}
+
+		const uint FileIndex = uint(Files.size());
+		Files.push_back(Path);
+
+		std::string Line;
+		uint LineNumber = 0;
+		while (std::getline(Stream, Line))
+		{
+			LineNumber++;
+			if (Depth == 0 && IsVersion(Line))
+			{
+				Text << Line << '\n';
+				for (const std::string& Define : Defines)
+				{
+					Text << "#define " << Define << '\n';
+				}
+				Text << "#line " << LineNumber + 1 << ' ' << FileIndex << '\n';
+				continue;
+			}
+
+			const std::string Name = IncludeName(Line);
+			if (Name.empty())
+			{
+				Text << Line << '\n';
+				continue;
+			}
+
+			const std::string IncludePath = DirectoryOf(Path) + Name;
+			if (std::find(Files.begin(), Files.end(), IncludePath) == Files.end())
+			{
+				if (Depth + 1 >= MaxIncludeDepth)
+				{
+					std::cout << "Shader includes nested too deep at " << IncludePath << std::endl;
+					return false;
+				}
+
+				Text << "#line 1 " << Files.size() << '\n';
+				if (!Expand(IncludePath, Defines, Depth + 1, Text, Files))
+				{
+					return false;
+				}
+			}
+			Text << "#line " << LineNumber + 1 << ' ' << FileIndex << '\n';
+		}
+		return true;
+	}
+}
+
+bool ShaderSource::Load(const std::string& Path, const std::vector<std::string>& Defines, ShaderSource& Out)
+{
+	std::ostringstream Text;
+	std::vector<std::string> Files;
+	if (!Expand(Path, Defines, 0, Text, Files))
+	{
+		return false;
+	}
+
+	Out.Text = Text.str();
+	Out.Files = std::move(Files);
+	return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "Core.h"
+#include <string>
+#include <vector>
+
+// GLSL after the build step: #include "File" expanded in place (relative to the including file,
+// each file at most once) and the permutation's defines inserted after #version. #line directives
+// keep compiler messages pointing at the original lines; the source string number is the index
+// into Files.
+struct ShaderSource
+{
+	std::string Text;
+	std::vector<std::string> Files; // The shader itself first, then everything it includes
+
+	// Defines are "NAME" or "NAME VALUE". False when Path or one of its includes cannot be read.
+	static bool Load(const std::string& Path, const std::vector<std::string>& Defines, ShaderSource& Out);
+};
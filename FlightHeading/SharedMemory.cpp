@@ -0,0 +1,133 @@
+#include "SharedMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::~SharedMemory()
+{
+	Close();
+}
+
+bool SharedMemory::Create(const std::string& Name, size_t InSize)
+{
+	return Map(Name, InSize, true);
+}
+
+bool SharedMemory::Open(const std::string& Name, size_t InSize)
+{
+	return Map(Name, InSize, false);
+}
+
+#ifdef _WIN32
+bool SharedMemory::Map(const std::string& Name, size_t InSize, bool Create)
+{
+	Close();
+
+	const std::string ObjectName = "Local\\" + Name;
+	HANDLE Mapping = Create
+		? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(uint64_t(InSize) >> 32), DWORD(InSize), ObjectName.c_str())
+		: OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, ObjectName.c_str());
+	if (!Mapping)
+	{
+		if (Create)
+		{
+			std::cout << "Could not create shared memory: " << Name << std::endl;
+		}
+		return false;
+	}
+
+	void* View = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, InSize);
+	if (!View)
+	{
+		std::cout << "Could not map shared memory: " << Name << std::endl;
+		CloseHandle(Mapping);
+		return false;
+	}
+
+	MappingHandle = Mapping;
+	Data = View;
+	Size = InSize;
+	return true;
+}
+
+void SharedMemory::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+		CloseHandle(MappingHandle);
+	}
+	Data = nullptr;
+	Size = 0;
+	MappingHandle = nullptr;
+}
+
+bool SharedMemory::Remove(const std::string&)
+{
+	return true;
+}
+#else
+bool SharedMemory::Map(const std::string& Name, size_t InSize, bool Create)
+{
+	Close();
+
+	const std::string ObjectName = "/" + Name;
+	const int Fd = shm_open(ObjectName.c_str(), Create ? O_RDWR | O_CREAT : O_RDWR, 0666);
+	if (Fd < 0)
+	{
+		if (Create)
+		{
+			std::cout << "Could not create shared memory: " << Name << std::endl;
+		}
+		return false;
+	}
+
+	// A segment that is still being sized by its creator is treated as absent
+	struct stat Stat;
+	if (fstat(Fd, &Stat) != 0 || (size_t(Stat.st_size) < InSize && (!Create || ftruncate(Fd, off_t(InSize)) != 0)))
+	{
+		if (Create)
+		{
+			std::cout << "Could not size shared memory: " << Name << std::endl;
+		}
+		close(Fd);
+		return false;
+	}
+
+	void* View = mmap(nullptr, InSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+	close(Fd);
+	if (View == MAP_FAILED)
+	{
+		std::cout << "Could not map shared memory: " << Name << std::endl;
+		return false;
+	}
+
+	Data = View;
+	Size = InSize;
+	return true;
+}
+
+void SharedMemory::Close()
+{
+	if (Data)
+	{
+		munmap(Data, Size);
+	}
+	Data = nullptr;
+	Size = 0;
+}
+
+bool SharedMemory::Remove(const std::string& Name)
+{
+	const std::string ObjectName = "/" + Name;
+	return shm_unlink(ObjectName.c_str()) == 0;
+}
+#endif
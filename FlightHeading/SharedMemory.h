@@ -0,0 +1,33 @@
+#pragma once
+#include "Core.h"
+#include <string>
+
+// Named shared memory segment that other processes on the host can map by name
+class SharedMemory : public Useful::NonCopyable
+{
+public:
+	SharedMemory() = default;
+	~SharedMemory();
+
+	// Creates the segment, or maps it if it already exists. New segments are zero filled.
+	bool Create(const std::string& Name, size_t InSize);
+	// Maps an existing segment; fails quietly if nobody has created it yet
+	bool Open(const std::string& Name, size_t InSize);
+	void Close();
+	// Frees the name so the next Create makes a new segment; existing mappings stay valid. On
+	// Windows a segment goes away with its last handle, so there is nothing to remove.
+	static bool Remove(const std::string& Name);
+
+	inline bool IsOpen() const { return Data != nullptr; }
+	inline void* GetData() const { return Data; }
+	inline size_t GetSize() const { return Size; }
+
+private:
+	void* Data = nullptr;
+	size_t Size = 0;
+#ifdef _WIN32
+	void* MappingHandle = nullptr;
+#endif
+
+	bool Map(const std::string& Name, size_t InSize, bool Create);
+};
@@ -0,0 +1,293 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	// Clamped before the conversion, which is undefined for NaN and for values past the int range
+	inline int ToCellCoord(float Cell)
+	{
+		if (!(Cell > -1.f))
+		{
+			return -1;
+		}
+		return int(std::min(Cell, float(SpatialIndex::MaxCellsPerAxis)));
+	}
+}
+
+SpatialIndex::SpatialIndex(float InCellSize)
+	: RequestedCellSize(InCellSize)
+{
+}
+
+void SpatialIndex::Build(const float* X, const float* Y, uint InCount)
+{
+	Count = InCount;
+	TargetCell.resize(Count);
+	TargetSlot.resize(Count);
+	PackedIndex.resize(Count);
+	PackedX.resize(Count);
+	PackedY.resize(Count);
+
+	float MinX = 0.f, MinY = 0.f, MaxX = 0.f, MaxY = 0.f;
+	if (Count > 0)
+	{
+		MinX = MaxX = X[0];
+		MinY = MaxY = Y[0];
+		for (uint i = 1; i < Count; i++)
+		{
+			MinX = std::min(MinX, X[i]);
+			MaxX = std::max(MaxX, X[i]);
+			MinY = std::min(MinY, Y[i]);
+			MaxY = std::max(MaxY, Y[i]);
+		}
+	}
+
+	ExtentX = std::max(MaxX - MinX, 1e-3f);
+	ExtentY = std::max(MaxY - MinY, 1e-3f);
+
+	CellSize = RequestedCellSize;
+	if (CellSize <= 0.f)
+	{
+		const float Area = ExtentX * ExtentY;
+		CellSize = std::sqrt(Area * TargetsPerCell / std::max(Count, 1u));
+	}
+	// Two cells of every axis are left for the margin below
+	CellSize = std::max(CellSize, std::max(ExtentX, ExtentY) / (MaxCellsPerAxis - 2));
+	InvCellSize = 1.f / CellSize;
+
+	// A cell of margin on every side, so targets moving outward stay on the Update path
+	OriginX = MinX - CellSize;
+	OriginY = MinY - CellSize;
+	ExtentX += 2.f * CellSize;
+	ExtentY += 2.f * CellSize;
+
+	CellsX = std::min(MaxCellsPerAxis, uint(ExtentX * InvCellSize) + 1);
+	CellsY = std::min(MaxCellsPerAxis, uint(ExtentY * InvCellSize) + 1);
+	CellStart.assign(CellsX * CellsY + 1, 0);
+
+	for (uint i = 0; i < Count; i++)
+	{
+		TargetCell[i] = CellOf(X[i], Y[i]);
+	}
+	SortIntoCells(X, Y);
+}
+
+void SpatialIndex::Update(const float* X, const float* Y, uint InCount)
+{
+	if (InCount != Count || CellsX == 0)
+	{
+		Build(X, Y, InCount);
+		return;
+	}
+
+	const float MaxX = OriginX + ExtentX;
+	const float MaxY = OriginY + ExtentY;
+	bool CellsChanged = false;
+
+	for (uint i = 0; i < Count; i++)
+	{
+		if (X[i] < OriginX || X[i] > MaxX || Y[i] < OriginY || Y[i] > MaxY)
+		{
+			Build(X, Y, InCount);
+			return;
+		}
+
+		const uint Cell = CellOf(X[i], Y[i]);
+		CellsChanged |= (Cell != TargetCell[i]);
+		TargetCell[i] = Cell;
+	}
+
+	if (CellsChanged)
+	{
+		SortIntoCells(X, Y);
+		return;
+	}
+
+	// Same cell membership, only refresh the packed positions
+	for (uint i = 0; i < Count; i++)
+	{
+		const uint Slot = TargetSlot[i];
+		PackedX[Slot] = X[i];
+		PackedY[Slot] = Y[i];
+	}
+}
+
+void SpatialIndex::QueryRange(float MinX, float MinY, float MaxX, float MaxY, std::vector<uint>& OutIndices) const
+{
+	if (Count == 0 || MinX > MaxX || MinY > MaxY)
+	{
+		return;
+	}
+
+	const int CX0 = std::max(CellCoordX(MinX), 0);
+	const int CY0 = std::max(CellCoordY(MinY), 0);
+	const int CX1 = std::min(CellCoordX(MaxX), int(CellsX) - 1);
+	const int CY1 = std::min(CellCoordY(MaxY), int(CellsY) - 1);
+	if (CX0 > CX1 || CY0 > CY1)
+	{
+		// Entirely outside the grid
+		return;
+	}
+
+	for (int CY = CY0; CY <= CY1; CY++)
+	{
+		const bool InnerRow = CY > CY0 && CY < CY1;
+
+		// Cells of one row are adjacent in the packed arrays, so the row is a single span
+		const uint Begin = CellStart[CY * CellsX + CX0];
+		const uint End = CellStart[CY * CellsX + CX1 + 1];
+
+		for (uint Slot = Begin; Slot < End; Slot++)
+		{
+			const float PX = PackedX[Slot];
+			const float PY = PackedY[Slot];
+			if (PX >= MinX && PX <= MaxX && (InnerRow || (PY >= MinY && PY <= MaxY)))
+			{
+				OutIndices.push_back(PackedIndex[Slot]);
+			}
+		}
+	}
+}
+
+void SpatialIndex::QueryNearest(float X, float Y, uint K, std::vector<uint>& OutIndices) const
+{
+	OutIndices.clear();
+	if (Count == 0 || K == 0)
+	{
+		return;
+	}
+	K = std::min(K, Count);
+
+	// Max-heap on squared distance holding the best K candidates so far
+	std::vector<std::pair<float, uint>> Best;
+	Best.reserve(K + 1);
+
+	const int QX = std::min(std::max(CellCoordX(X), 0), int(CellsX) - 1);
+	const int QY = std::min(std::max(CellCoordY(Y), 0), int(CellsY) - 1);
+	const int MaxRing = int(std::max(CellsX, CellsY));
+
+	auto VisitCells = [&](int CY, int CX0, int CX1)
+	{
+		if (CY < 0 || CY >= int(CellsY))
+		{
+			return;
+		}
+		CX0 = std::max(CX0, 0);
+		CX1 = std::min(CX1, int(CellsX) - 1);
+		if (CX0 > CX1)
+		{
+			return;
+		}
+
+		const uint Begin = CellStart[CY * CellsX + CX0];
+		const uint End = CellStart[CY * CellsX + CX1 + 1];
+		for (uint Slot = Begin; Slot < End; Slot++)
+		{
+			const float DX = PackedX[Slot] - X;
+			const float DY = PackedY[Slot] - Y;
+			const float Dist2 = DX * DX + DY * DY;
+
+			if (Best.size() < K)
+			{
+				Best.emplace_back(Dist2, PackedIndex[Slot]);
+				std::push_heap(Best.begin(), Best.end());
+			}
+			else if (Dist2 < Best.front().first)
+			{
+				std::pop_heap(Best.begin(), Best.end());
+				Best.back() = std::make_pair(Dist2, PackedIndex[Slot]);
+				std::push_heap(Best.begin(), Best.end());
+			}
+		}
+	};
+
+	for (int Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		if (Ring == 0)
+		{
+			VisitCells(QY, QX, QX);
+		}
+		else
+		{
+			VisitCells(QY - Ring, QX - Ring, QX + Ring);
+			VisitCells(QY + Ring, QX - Ring, QX + Ring);
+			for (int CY = QY - Ring + 1; CY <= QY + Ring - 1; CY++)
+			{
+				VisitCells(CY, QX - Ring, QX - Ring);
+				VisitCells(CY, QX + Ring, QX + Ring);
+			}
+		}
+
+		if (Best.size() == K)
+		{
+			// Anything outside the visited block is at least this far from the query point
+			const float Left = X - (OriginX + (QX - Ring) * CellSize);
+			const float Right = OriginX + (QX + Ring + 1) * CellSize - X;
+			const float Bottom = Y - (OriginY + (QY - Ring) * CellSize);
+			const float Top = OriginY + (QY + Ring + 1) * CellSize - Y;
+			const float Margin = std::min(std::min(Left, Right), std::min(Bottom, Top));
+
+			if (Margin > 0.f && Margin * Margin >= Best.front().first)
+			{
+				break;
+			}
+		}
+	}
+
+	std::sort_heap(Best.begin(), Best.end());
+	OutIndices.reserve(Best.size());
+	for (const auto& Candidate : Best)
+	{
+		OutIndices.push_back(Candidate.second);
+	}
+}
+
+uint SpatialIndex::CellOf(float X, float Y) const
+{
+	const int CX = std::min(std::max(CellCoordX(X), 0), int(CellsX) - 1);
+	const int CY = std::min(std::max(CellCoordY(Y), 0), int(CellsY) - 1);
+	return uint(CY) * CellsX + uint(CX);
+}
+
+// Truncation instead of floor: callers clamp to the grid, where both agree. Anything beyond it,
+// NaN included, comes back as -1 or MaxCellsPerAxis.
+inline int SpatialIndex::CellCoordX(float X) const
+{
+	return ToCellCoord((X - OriginX) * InvCellSize);
+}
+
+inline int SpatialIndex::CellCoordY(float Y) const
+{
+	return ToCellCoord((Y - OriginY) * InvCellSize);
+}
+
+void SpatialIndex::SortIntoCells(const float* X, const float* Y)
+{
+	std::fill(CellStart.begin(), CellStart.end(), 0);
+
+	for (uint i = 0; i < Count; i++)
+	{
+		CellStart[TargetCell[i] + 1]++;
+	}
+	for (size_t Cell = 1; Cell < CellStart.size(); Cell++)
+	{
+		CellStart[Cell] += CellStart[Cell - 1];
+	}
+
+	// Scatter using CellStart as the write cursor, then shift it back into place
+	for (uint i = 0; i < Count; i++)
+	{
+		const uint Slot = CellStart[TargetCell[i]]++;
+		TargetSlot[i] = Slot;
+		PackedIndex[Slot] = i;
+		PackedX[Slot] = X[i];
+		PackedY[Slot] = Y[i];
+	}
+	for (size_t Cell = CellStart.size() - 1; Cell > 0; Cell--)
+	{
+		CellStart[Cell] = CellStart[Cell - 1];
+	}
+	CellStart[0] = 0;
+}
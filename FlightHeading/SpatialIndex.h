@@ -0,0 +1,53 @@
+#pragma once
+#include "Core.h"
+#include <vector>
+
+// Uniform grid over 2D target positions (e.g. traffic east/north or screen space).
+// Targets are bucketed with a counting sort, so the members of a cell and a copy of their
+// positions sit contiguously in memory and queries only stream through packed arrays.
+class SpatialIndex
+{
+public:
+	// CellSize <= 0 picks a size that keeps roughly TargetsPerCell targets in each cell.
+	explicit SpatialIndex(float InCellSize = 0.f);
+
+	// Full rebuild: recomputes bounds, grid dimensions and the cell ordering. The bounds get a
+	// margin of one cell on every side.
+	void Build(const float* X, const float* Y, uint InCount);
+	// Per-tick update for the same target set. Keeps the grid and only re-sorts when a target
+	// crossed a cell boundary; falls back to Build when the count changed or a target left the bounds.
+	void Update(const float* X, const float* Y, uint InCount);
+
+	// Appends the indices of all targets inside the rectangle (inclusive).
+	void QueryRange(float MinX, float MinY, float MaxX, float MaxY, std::vector<uint>& OutIndices) const;
+	// Writes the indices of the K closest targets, nearest first.
+	void QueryNearest(float X, float Y, uint K, std::vector<uint>& OutIndices) const;
+
+	inline uint GetCount() const { return Count; }
+	inline uint GetCellCount() const { return CellsX * CellsY; }
+	inline float GetCellSize() const { return CellSize; }
+
+	static constexpr uint TargetsPerCell = 4;
+	static constexpr uint MaxCellsPerAxis = 2048;
+
+private:
+	float RequestedCellSize;
+	float CellSize = 1.f;
+	float InvCellSize = 1.f;
+	float OriginX = 0.f, OriginY = 0.f;
+	float ExtentX = 0.f, ExtentY = 0.f;
+	uint CellsX = 0, CellsY = 0;
+	uint Count = 0;
+
+	std::vector<uint> CellStart;    // CellsX * CellsY + 1 offsets into the packed arrays
+	std::vector<uint> PackedIndex;  // Target index, in cell order
+	std::vector<float> PackedX;     // Positions, in cell order
+	std::vector<float> PackedY;
+	std::vector<uint> TargetCell;   // Cell of each target, in input order
+	std::vector<uint> TargetSlot;   // Position of each target in the packed arrays
+
+	uint CellOf(float X, float Y) const;
+	inline int CellCoordX(float X) const;
+	inline int CellCoordY(float Y) const;
+	void SortIntoCells(const float* X, const float* Y);
+};
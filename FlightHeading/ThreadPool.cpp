@@ -0,0 +1,131 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+
+namespace
+{
+	// Pool and worker index of the calling thread, so nested submits land in the local deque
+	thread_local const ThreadPool* CurrentPool = nullptr;
+	thread_local uint CurrentWorker = 0;
+}
+
+ThreadPool::ThreadPool(uint ThreadCount)
+{
+	if (ThreadCount == 0)
+	{
+		ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	for (uint i = 0; i < ThreadCount; i++)
+	{
+		Workers.push_back(std::make_unique<Worker>());
+	}
+	for (uint i = 0; i < ThreadCount; i++)
+	{
+		Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	Wait();
+	{
+		std::lock_guard<std::mutex> Lock(SleepMutex);
+		Stopping = true;
+	}
+	WakeCondition.notify_all();
+
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> Task)
+{
+	const uint Index = CurrentPool == this ? CurrentWorker : NextWorker.fetch_add(1, std::memory_order_relaxed) % uint(Workers.size());
+
+	Pending.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> Lock(Workers[Index]->Mutex);
+		Workers[Index]->Tasks.push_back(std::move(Task));
+		Queued.fetch_add(1);
+	}
+
+	// Taking the lock orders this against a worker that is about to sleep
+	std::lock_guard<std::mutex> Lock(SleepMutex);
+	WakeCondition.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> Lock(SleepMutex);
+	IdleCondition.wait(Lock, [this]() { return Pending.load() == 0; });
+}
+
+bool ThreadPool::TryPop(uint Index, std::function<void()>& OutTask)
+{
+	Worker& Own = *Workers[Index];
+	std::lock_guard<std::mutex> Lock(Own.Mutex);
+	if (Own.Tasks.empty())
+	{
+		return false;
+	}
+
+	OutTask = std::move(Own.Tasks.back());
+	Own.Tasks.pop_back();
+	Queued.fetch_sub(1);
+	return true;
+}
+
+bool ThreadPool::TrySteal(uint Thief, std::function<void()>& OutTask)
+{
+	const uint Count = uint(Workers.size());
+	for (uint Offset = 1; Offset < Count; Offset++)
+	{
+		Worker& Victim = *Workers[(Thief + Offset) % Count];
+		std::lock_guard<std::mutex> Lock(Victim.Mutex);
+		if (!Victim.Tasks.empty())
+		{
+			OutTask = std::move(Victim.Tasks.front());
+			Victim.Tasks.pop_front();
+			Queued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::WorkerLoop(uint Index)
+{
+	TRACE_THREAD("Worker");
+	CurrentPool = this;
+	CurrentWorker = Index;
+
+	std::function<void()> Task;
+	while (true)
+	{
+		if (TryPop(Index, Task) || TrySteal(Index, Task))
+		{
+			{
+				TRACE_SCOPE("Task");
+				Task();
+			}
+			Task = nullptr;
+
+			if (Pending.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> Lock(SleepMutex);
+				IdleCondition.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<std::mutex> Lock(SleepMutex);
+		WakeCondition.wait(Lock, [this]() { return Stopping || Queued.load() > 0; });
+		if (Stopping && Queued.load() == 0)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Every worker owns a deque: it pops its own tasks newest first and, when it
+// runs dry, steals the oldest task of another worker. Tasks submitted from inside a task go to the
+// submitting worker's deque, so nested work stays on the core that produced it.
+class ThreadPool : public Useful::NonCopyable
+{
+public:
+	// ThreadCount 0 uses one worker per hardware thread
+	explicit ThreadPool(uint ThreadCount = 0);
+	~ThreadPool();
+
+	void Submit(std::function<void()> Task);
+	// Blocks until every submitted task has finished
+	void Wait();
+
+	inline uint GetThreadCount() const { return uint(Threads.size()); }
+
+private:
+	struct Worker
+	{
+		std::mutex Mutex;
+		std::deque<std::function<void()>> Tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker>> Workers;
+	std::vector<std::thread> Threads;
+	std::atomic<uint> NextWorker{ 0 };
+	std::atomic<uint64_t> Queued{ 0 };
+	std::atomic<uint64_t> Pending{ 0 };
+	std::mutex SleepMutex;
+	std::condition_variable WakeCondition;
+	std::condition_variable IdleCondition;
+	bool Stopping = false;
+
+	bool TryPop(uint Index, std::function<void()>& OutTask);
+	bool TrySteal(uint Thief, std::function<void()>& OutTask);
+	void WorkerLoop(uint Index);
+};
@@ -0,0 +1,192 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	constexpr uint EventCapacity = 1 << 16;
+
+	struct Event
+	{
+		const char* Name;
+		uint64_t StartTicks;
+		uint64_t EndTicks;
+		double Value; // Counters only
+		bool IsCounter;
+	};
+
+	// Written only by its thread. The collector reads Count with acquire and never looks past it.
+	struct ThreadBuffer
+	{
+		uint ThreadID = 0;
+		std::atomic<const char*> Name{ nullptr };
+		std::atomic<uint> Generation{ 0 };
+		std::atomic<uint> Count{ 0 };
+		std::atomic<uint> Dropped{ 0 };
+		std::unique_ptr<Event[]> Events{ new Event[EventCapacity] };
+	};
+
+	// Buffers outlive their threads so nothing recorded is lost before Stop, one per thread ever traced
+	std::mutex RegistryMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+
+	std::atomic<uint> CurrentGeneration{ 1 };
+	uint64_t SessionStartTicks = 0;
+	std::chrono::steady_clock::time_point SessionStartTime;
+	thread_local ThreadBuffer* LocalBuffer = nullptr;
+
+	ThreadBuffer& GetLocalBuffer()
+	{
+		if (!LocalBuffer)
+		{
+			std::lock_guard<std::mutex> Lock(RegistryMutex);
+			Buffers.push_back(std::make_unique<ThreadBuffer>());
+			Buffers.back()->ThreadID = uint(Buffers.size());
+			// Touch every page here rather than page faulting on the first events of a capture
+			std::fill_n(Buffers.back()->Events.get(), EventCapacity, Event{ "", 0, 0, 0.0, false });
+			LocalBuffer = Buffers.back().get();
+		}
+		return *LocalBuffer;
+	}
+
+	void WriteEscaped(std::string& Out, const char* Text)
+	{
+		for (; *Text; Text++)
+		{
+			if (*Text == '"' || *Text == '\\')
+			{
+				Out += '\\';
+			}
+			Out += *Text;
+		}
+	}
+
+	// Only the owning thread writes its buffer
+	void Append(const Event& NewEvent)
+	{
+		ThreadBuffer& Buffer = GetLocalBuffer();
+
+		// First event of a new session on this thread, forget the previous one
+		const uint Generation = CurrentGeneration.load(std::memory_order_relaxed);
+		if (Buffer.Generation.load(std::memory_order_relaxed) != Generation)
+		{
+			Buffer.Count.store(0, std::memory_order_relaxed);
+			Buffer.Dropped.store(0, std::memory_order_relaxed);
+			Buffer.Generation.store(Generation, std::memory_order_release);
+		}
+
+		const uint Count = Buffer.Count.load(std::memory_order_relaxed);
+		if (Count >= EventCapacity)
+		{
+			Buffer.Dropped.store(Buffer.Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+
+		Buffer.Events[Count] = NewEvent;
+		Buffer.Count.store(Count + 1, std::memory_order_release);
+	}
+}
+
+std::atomic<bool> Trace::Detail::Recording{ false };
+
+void Trace::Start()
+{
+	SessionStartTime = std::chrono::steady_clock::now();
+	SessionStartTicks = Now();
+	CurrentGeneration.fetch_add(1, std::memory_order_relaxed);
+	Detail::Recording.store(true, std::memory_order_release);
+}
+
+bool Trace::Stop(const std::string& Path)
+{
+	Detail::Recording.store(false, std::memory_order_release);
+
+	const uint Generation = CurrentGeneration.load(std::memory_order_relaxed);
+
+	// Tick rate measured over the whole session
+	const uint64_t ElapsedTicks = Now() - SessionStartTicks;
+	const double ElapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - SessionStartTime).count();
+	const double UsPerTick = ElapsedTicks > 0 && ElapsedUs > 0.0 ? ElapsedUs / double(ElapsedTicks) : 1e-3;
+
+	std::string Json = "{\"traceEvents\":[\n";
+	char Line[160];
+	uint64_t TotalDropped = 0;
+	bool First = true;
+
+	std::lock_guard<std::mutex> Lock(RegistryMutex);
+	for (const std::unique_ptr<ThreadBuffer>& Buffer : Buffers)
+	{
+		const char* ThreadName = Buffer->Name.load(std::memory_order_acquire);
+		if (ThreadName)
+		{
+			std::snprintf(Line, sizeof(Line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", First ? "" : ",\n", Buffer->ThreadID);
+			Json += Line;
+			WriteEscaped(Json, ThreadName);
+			Json += "\"}}";
+			First = false;
+		}
+
+		if (Buffer->Generation.load(std::memory_order_acquire) != Generation)
+		{
+			continue;
+		}
+
+		const uint Count = Buffer->Count.load(std::memory_order_acquire);
+		TotalDropped += Buffer->Dropped.load(std::memory_order_relaxed);
+		for (uint i = 0; i < Count; i++)
+		{
+			const Event& E = Buffer->Events[i];
+			const uint64_t EventStart = E.StartTicks > SessionStartTicks ? E.StartTicks : SessionStartTicks;
+			Json += First ? "{\"name\":\"" : ",\n{\"name\":\"";
+			WriteEscaped(Json, E.Name);
+			First = false;
+			if (E.IsCounter)
+			{
+				std::snprintf(Line, sizeof(Line), "\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.6g}}",
+					Buffer->ThreadID, (EventStart - SessionStartTicks) * UsPerTick, E.Value);
+				Json += Line;
+				continue;
+			}
+			std::snprintf(Line, sizeof(Line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				Buffer->ThreadID, (EventStart - SessionStartTicks) * UsPerTick, (E.EndTicks - EventStart) * UsPerTick);
+			Json += Line;
+			First = false;
+		}
+	}
+	Json += "\n]}\n";
+
+	if (TotalDropped > 0)
+	{
+		std::cout << "Trace buffers were full, " << TotalDropped << " events dropped" << std::endl;
+	}
+
+	std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+	if (!Stream.is_open())
+	{
+		std::cout << "Could not write trace: " << Path << std::endl;
+		return false;
+	}
+	Stream << Json;
+	return Stream.good();
+}
+
+void Trace::SetThreadName(const char* Name)
+{
+	GetLocalBuffer().Name.store(Name, std::memory_order_release);
+}
+
+void Trace::Record(const char* Name, uint64_t StartTicks, uint64_t EndTicks)
+{
+	Append(Event{ Name, StartTicks, EndTicks, 0.0, false });
+}
+
+void Trace::RecordCounter(const char* Name, double Value)
+{
+	const uint64_t Ticks = Now();
+	Append(Event{ Name, Ticks, Ticks, Value, true });
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define TRACE_USE_TSC 1
+#else
+#define TRACE_USE_TSC 0
+#endif
+
+// Timeline tracing. Every thread appends complete events to its own buffer without locks; Stop
+// collects the buffers and writes Chrome trace JSON, which chrome://tracing and ui.perfetto.dev open.
+// Build with ENABLE_TRACE=0 to compile every TRACE_ macro out.
+#ifndef ENABLE_TRACE
+#define ENABLE_TRACE 1
+#endif
+
+namespace Trace
+{
+	namespace Detail
+	{
+		extern std::atomic<bool> Recording;
+	}
+
+	// Drops anything recorded before and starts recording on every thread
+	void Start();
+	// Stops recording and writes what every thread recorded since Start
+	bool Stop(const std::string& Path);
+	inline bool IsRecording() { return Detail::Recording.load(std::memory_order_relaxed); }
+
+	// Names the calling thread in the timeline. Name must be a string literal, it is stored as is.
+	void SetThreadName(const char* Name);
+
+	// Timestamp in ticks: the time stamp counter where there is one (a few ns to read, steady_clock
+	// can cost 20-50), nanoseconds otherwise. Stop converts ticks against steady_clock.
+	inline uint64_t Now()
+	{
+#if TRACE_USE_TSC
+		return __rdtsc();
+#else
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	// Name must be a string literal
+	void Record(const char* Name, uint64_t StartTicks, uint64_t EndTicks);
+	// Sample of a value plotted over time (a counter track in the viewer). Name must be a string literal.
+	void RecordCounter(const char* Name, double Value);
+
+	// Not Useful::NonCopyable, a vtable on every scope is not free
+	class Scope
+	{
+	public:
+		explicit Scope(const char* InName) : Name(InName), Active(IsRecording()), StartTicks(Active ? Now() : 0) {}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope()
+		{
+			if (Active)
+			{
+				Record(Name, StartTicks, Now());
+			}
+		}
+
+	private:
+		const char* Name;
+		const bool Active;
+		const uint64_t StartTicks;
+	};
+}
+
+#if ENABLE_TRACE
+#define TRACE_CONCAT_INNER(A, B) A##B
+#define TRACE_CONCAT(A, B) TRACE_CONCAT_INNER(A, B)
+#define TRACE_SCOPE(Name) Trace::Scope TRACE_CONCAT(TraceScope, __LINE__)(Name)
+#define TRACE_THREAD(Name) Trace::SetThreadName(Name)
+#define TRACE_COUNTER(Name, Value) do { if (Trace::IsRecording()) { Trace::RecordCounter(Name, Value); } } while (0)
+#else
+#define TRACE_SCOPE(Name)
+#define TRACE_THREAD(Name)
+#define TRACE_COUNTER(Name, Value) do { } while (0)
+#endif
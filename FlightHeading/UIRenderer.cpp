@@ -0,0 +1,201 @@
+#include "UIRenderer.h"
+#include "Helper.h"
+#include "ResourceMemory.h"
+#include "Trace.h"
+#include <imgui/imgui.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// FNV-1a over 8 byte words, then the tail bytes
+	uint64_t HashBytes(uint64_t Hash, const void* Data, size_t Size)
+	{
+		constexpr uint64_t Prime = 0x100000001b3ull;
+		const uchar* Bytes = static_cast<const uchar*>(Data);
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= Size; i += sizeof(uint64_t))
+		{
+			uint64_t Word;
+			std::memcpy(&Word, Bytes + i, sizeof(Word));
+			Hash = (Hash ^ Word) * Prime;
+		}
+		for (; i < Size; i++)
+		{
+			Hash = (Hash ^ Bytes[i]) * Prime;
+		}
+		return Hash;
+	}
+
+	template<typename T>
+	uint64_t HashVector(uint64_t Hash, const ImVector<T>& Vector)
+	{
+		Hash = HashBytes(Hash, &Vector.Size, sizeof(Vector.Size));
+		return HashBytes(Hash, Vector.Data, size_t(Vector.Size) * sizeof(T));
+	}
+}
+
+UIRenderer::UIRenderer()
+	: VertexArrayID(0), VertexBufferID(0), IndexBufferID(0), MemoryID(ResourceMemory::Register(ResourceMemory::Kind::Buffer, "UI buffers")),
+	CachedHash(0), Projection(1.f), FramebufferWidth(0), FramebufferHeight(0)
+{
+	GLCALL(glGenVertexArrays(1, &VertexArrayID));
+	GLCALL(glGenBuffers(1, &VertexBufferID));
+	GLCALL(glGenBuffers(1, &IndexBufferID));
+
+	// ImDrawVert: position and UV as floats, color as four normalized bytes
+	GLCALL(glBindVertexArray(VertexArrayID));
+	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID));
+	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID));
+	GLCALL(glEnableVertexAttribArray(0));
+	GLCALL(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, pos)));
+	GLCALL(glEnableVertexAttribArray(1));
+	GLCALL(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, uv)));
+	GLCALL(glEnableVertexAttribArray(2));
+	GLCALL(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, col)));
+	GLCALL(glBindVertexArray(0));
+}
+
+UIRenderer::~UIRenderer()
+{
+	GLCALL(glDeleteBuffers(1, &IndexBufferID));
+	GLCALL(glDeleteBuffers(1, &VertexBufferID));
+	GLCALL(glDeleteVertexArrays(1, &VertexArrayID));
+	ResourceMemory::Unregister(MemoryID);
+}
+
+uint64_t UIRenderer::Hash(const ImDrawData& DrawData)
+{
+	TRACE_SCOPE("HashUI");
+	uint64_t Hash = 0xcbf29ce484222325ull;
+	const float Display[] = { DrawData.DisplayPos.x, DrawData.DisplayPos.y, DrawData.DisplaySize.x, DrawData.DisplaySize.y, DrawData.FramebufferScale.x, DrawData.FramebufferScale.y };
+	Hash = HashBytes(Hash, Display, sizeof(Display));
+	for (const ImDrawList* List : DrawData.CmdLists)
+	{
+		// ImDrawCmd zeroes its padding, so whole commands can be hashed
+		Hash = HashVector(Hash, List->CmdBuffer);
+		Hash = HashVector(Hash, List->IdxBuffer);
+		Hash = HashVector(Hash, List->VtxBuffer);
+	}
+	// 0 is reserved for "always upload"
+	return Hash != 0 ? Hash : 1;
+}
+
+void UIRenderer::Render(const ImDrawData& DrawData, uint64_t DataHash, Shader& Program)
+{
+	if (DataHash == 0 || DataHash != CachedHash)
+	{
+		Upload(DrawData);
+		CachedHash = DataHash;
+	}
+	Draw(Program);
+}
+
+void UIRenderer::RenderCached(Shader& Program)
+{
+	Draw(Program);
+}
+
+void UIRenderer::Upload(const ImDrawData& DrawData)
+{
+	TRACE_SCOPE("UploadUI");
+	FramebufferWidth = int(DrawData.DisplaySize.x * DrawData.FramebufferScale.x);
+	FramebufferHeight = int(DrawData.DisplaySize.y * DrawData.FramebufferScale.y);
+	const float Left = DrawData.DisplayPos.x;
+	const float Top = DrawData.DisplayPos.y;
+	Projection = glm::ortho(Left, Left + DrawData.DisplaySize.x, Top + DrawData.DisplaySize.y, Top, -1.f, 1.f);
+
+	// Every list goes into the same two buffers, drawn with a base vertex per list
+	const size_t VertexBytes = size_t(DrawData.TotalVtxCount) * sizeof(ImDrawVert);
+	const size_t IndexBytes = size_t(DrawData.TotalIdxCount) * sizeof(ImDrawIdx);
+	GLCALL(glBindVertexArray(VertexArrayID));
+	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID));
+	GLCALL(glBufferData(GL_ARRAY_BUFFER, VertexBytes, nullptr, GL_DYNAMIC_DRAW));
+	GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexBytes, nullptr, GL_DYNAMIC_DRAW));
+	ResourceMemory::SetBytes(MemoryID, VertexBytes + IndexBytes);
+
+	Commands.clear();
+	const ImVec2 ClipOffset = DrawData.DisplayPos;
+	const ImVec2 ClipScale = DrawData.FramebufferScale;
+	uint VertexOffset = 0;
+	uint IndexOffset = 0;
+	for (const ImDrawList* List : DrawData.CmdLists)
+	{
+		GLCALL(glBufferSubData(GL_ARRAY_BUFFER, VertexOffset * sizeof(ImDrawVert), List->VtxBuffer.Size * sizeof(ImDrawVert), List->VtxBuffer.Data));
+		GLCALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, IndexOffset * sizeof(ImDrawIdx), List->IdxBuffer.Size * sizeof(ImDrawIdx), List->IdxBuffer.Data));
+
+		for (const ImDrawCmd& Cmd : List->CmdBuffer)
+		{
+			// ResetRenderState is implied, every command sets all of its state
+			if (Cmd.UserCallback)
+			{
+				continue;
+			}
+
+			// Scissor rectangles in framebuffer pixels, Y up
+			const float MinX = (Cmd.ClipRect.x - ClipOffset.x) * ClipScale.x;
+			const float MinY = (Cmd.ClipRect.y - ClipOffset.y) * ClipScale.y;
+			const float MaxX = (Cmd.ClipRect.z - ClipOffset.x) * ClipScale.x;
+			const float MaxY = (Cmd.ClipRect.w - ClipOffset.y) * ClipScale.y;
+			if (MaxX <= MinX || MaxY <= MinY || Cmd.ElemCount == 0)
+			{
+				continue;
+			}
+
+			DrawCommand Command;
+			Command.ScissorX = int(MinX);
+			Command.ScissorY = int(float(FramebufferHeight) - MaxY);
+			Command.ScissorWidth = int(MaxX - MinX);
+			Command.ScissorHeight = int(MaxY - MinY);
+			Command.TextureID = uint(Cmd.GetTexID());
+			Command.ElementCount = Cmd.ElemCount;
+			Command.IndexOffset = IndexOffset + Cmd.IdxOffset;
+			Command.BaseVertex = int(VertexOffset + Cmd.VtxOffset);
+			Commands.push_back(Command);
+		}
+
+		VertexOffset += uint(List->VtxBuffer.Size);
+		IndexOffset += uint(List->IdxBuffer.Size);
+	}
+	GLCALL(glBindVertexArray(0));
+}
+
+void UIRenderer::Draw(Shader& Program) const
+{
+	TRACE_SCOPE("DrawUI");
+	if (Commands.empty())
+	{
+		return;
+	}
+
+	GLCALL(glEnable(GL_BLEND));
+	GLCALL(glBlendEquation(GL_FUNC_ADD));
+	GLCALL(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+	GLCALL(glDisable(GL_CULL_FACE));
+	GLCALL(glDisable(GL_DEPTH_TEST));
+	GLCALL(glEnable(GL_SCISSOR_TEST));
+	GLCALL(glViewport(0, 0, FramebufferWidth, FramebufferHeight));
+
+	Program.Bind();
+	Program.SetUniformMatrix4f("projection", Projection);
+	GLCALL(glActiveTexture(GL_TEXTURE0));
+	GLCALL(glBindVertexArray(VertexArrayID));
+
+	const GLenum IndexType = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	uint BoundTexture = ~0u;
+	for (const DrawCommand& Command : Commands)
+	{
+		GLCALL(glScissor(Command.ScissorX, Command.ScissorY, Command.ScissorWidth, Command.ScissorHeight));
+		if (Command.TextureID != BoundTexture)
+		{
+			GLCALL(glBindTexture(GL_TEXTURE_2D, Command.TextureID));
+			BoundTexture = Command.TextureID;
+		}
+		GLCALL(glDrawElementsBaseVertex(GL_TRIANGLES, GLsizei(Command.ElementCount), IndexType, (const void*)(size_t(Command.IndexOffset) * sizeof(ImDrawIdx)), Command.BaseVertex));
+	}
+
+	GLCALL(glBindVertexArray(0));
+	GLCALL(glDisable(GL_SCISSOR_TEST));
+	GLCALL(glDisable(GL_BLEND));
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Core.h"
+#include <vector>
+#include <glm/mat4x4.hpp>
+
+struct ImDrawData;
+class Shader;
+
+// Draws ImGui draw data from one vertex and one index buffer that are kept between frames. Data
+// that hashes the same as the last upload is not uploaded again, and RenderCached draws the last
+// upload with no draw data at all, so a static Control Panel costs a few draw calls and no
+// uploads. Of the user callbacks only ImDrawCallback_ResetRenderState is supported, the UI adds
+// no others.
+class UIRenderer : public Useful::NonCopyable
+{
+public:
+	UIRenderer();
+	~UIRenderer();
+
+	// Of everything that reaches the screen: display rectangle, vertices, indices and commands
+	static uint64_t Hash(const ImDrawData& DrawData);
+
+	// Uploads DrawData unless DataHash is the one uploaded last (0 always uploads), then draws it
+	void Render(const ImDrawData& DrawData, uint64_t DataHash, Shader& Program);
+	void RenderCached(Shader& Program);
+
+	inline uint64_t GetHash() const { return CachedHash; }
+
+private:
+	struct DrawCommand
+	{
+		int ScissorX, ScissorY, ScissorWidth, ScissorHeight;
+		uint TextureID;
+		uint ElementCount;
+		uint IndexOffset; // In elements
+		int BaseVertex;
+	};
+
+	uint VertexArrayID;
+	uint VertexBufferID;
+	uint IndexBufferID;
+	uint MemoryID;
+	uint64_t CachedHash;
+	std::vector<DrawCommand> Commands;
+	glm::mat4 Projection;
+	int FramebufferWidth, FramebufferHeight;
+
+	void Upload(const ImDrawData& DrawData);
+	void Draw(Shader& Program) const;
+};
@@ -0,0 +1,30 @@
+#version 330 core
+// Bufferless quads: corners come from gl_VertexID (a 4 vertex triangle strip), the transform from
+// two texels per instance, (M00, M10, M01, M11) and (Tx, Ty, unused, unused). Gauges that follow the
+// heading are turned by the frame block, so per-frame changes are a single uniform buffer write.
+//
+// Permutations: ATLAS samples the gauge's region of a shared texture instead of the whole texture.
+
+#include "GaugeBlocks.glsl"
+
+out vec2 texCoord;
+uniform samplerBuffer instances;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+#ifdef ATLAS
+	texCoord = gauge.uvRect.xy + corner * gauge.uvRect.zw;
+#else
+	texCoord = corner;
+#endif
+
+	float angle = radians(frame.headingDegrees * gauge.headingFollow);
+	mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+
+	int instance = 2 * (gauge.firstInstance + gl_InstanceID);
+	vec4 linear = texelFetch(instances, instance);
+	vec2 translation = texelFetch(instances, instance + 1).xy;
+	vec2 position = rotation * (corner * 2.f - 1.f);
+	gl_Position = vec4(mat2(linear.xy, linear.zw) * position + translation, 0.f, 1.f);
+}
@@ -0,0 +1,40 @@
+#version 330 core
+// Gauge textures are premultiplied at load. Permutations:
+//   ALPHA_TEST <threshold>  discards fragments at or below the threshold alpha, no blending
+//   ALPHA_TO_COVERAGE       alpha becomes the sample mask, for MSAA targets, no blending
+//   (neither)               premultiplied output for glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+//   SDF                     the texture is a distance field in alpha (0.5 on the edge) tinted
+//                           with the gauge tint, instead of a color bitmap
+
+#include "GaugeBlocks.glsl"
+
+out vec4 fragColor;
+in vec2 texCoord;
+uniform sampler2D rectTexture;
+
+void main()
+{
+	vec4 tint = vec4(gauge.tint.rgb * gauge.tint.a, gauge.tint.a);
+#ifdef SDF
+	float fieldDistance = texture(rectTexture, texCoord).a;
+	float edgeWidth = fwidth(fieldDistance);
+	vec4 color = tint * smoothstep(0.5f - edgeWidth, 0.5f + edgeWidth, fieldDistance);
+#else
+	vec4 color = texture(rectTexture, texCoord) * tint;
+#endif
+
+#if defined(ALPHA_TEST)
+	if(color.a <= ALPHA_TEST)
+	{
+		discard;
+	}
+	fragColor = vec4(color.rgb / color.a, 1.f);
+#elif defined(ALPHA_TO_COVERAGE)
+	// Coverage does the blending, so the color goes out straight. Alpha is sharpened to a one
+	// pixel wide ramp, which keeps edges crisp instead of fading over the whole mip footprint.
+	float alpha = clamp((color.a - 0.5f) / max(fwidth(color.a), 1e-4f) + 0.5f, 0.f, 1.f);
+	fragColor = vec4(color.rgb / max(color.a, 1e-4f), alpha);
+#else
+	fragColor = color;
+#endif
+}
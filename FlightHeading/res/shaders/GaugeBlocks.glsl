@@ -0,0 +1,17 @@
+// Uniform blocks shared by the gauge shaders; member offsets must match the std140 layouts in
+// Application.cpp
+
+layout(std140) uniform FrameBlock
+{
+	vec2 viewportSize;
+	float timeSeconds;
+	float headingDegrees;
+} frame;
+
+layout(std140) uniform GaugeBlock
+{
+	vec4 tint;
+	vec4 uvRect;         // Atlas region: offset in xy, size in zw
+	int firstInstance;
+	float headingFollow; // 1 turns with the heading, 0 stays fixed
+} gauge;
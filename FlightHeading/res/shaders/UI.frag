@@ -0,0 +1,12 @@
+#version 330 core
+// Straight alpha, blended with SRC_ALPHA, ONE_MINUS_SRC_ALPHA like ImGui's own backend
+
+out vec4 fragColor;
+in vec2 texCoord;
+in vec4 vertexColor;
+uniform sampler2D uiTexture;
+
+void main()
+{
+	fragColor = vertexColor * texture(uiTexture, texCoord);
+}
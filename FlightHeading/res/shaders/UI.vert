@@ -0,0 +1,17 @@
+#version 330 core
+// ImGui vertices: position in display coordinates, UV into the font atlas, color as 4 normalized bytes
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec4 color;
+
+out vec2 texCoord;
+out vec4 vertexColor;
+uniform mat4 projection;
+
+void main()
+{
+	texCoord = uv;
+	vertexColor = color;
+	gl_Position = projection * vec4(position, 0.f, 1.f);
+}
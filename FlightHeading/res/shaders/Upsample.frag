@@ -0,0 +1,14 @@
+#version 330 core
+// Bilinear upsample; at a scale of 1 every fragment lands on a texel center and it is an exact copy.
+// Samples are clamped inside the rendered corner so its edge never blends with stale texels.
+
+out vec4 fragColor;
+in vec2 texCoord;
+uniform sampler2D sourceTexture;
+uniform vec2 sourceScale;
+
+void main()
+{
+	vec2 halfTexel = 0.5f / vec2(textureSize(sourceTexture, 0));
+	fragColor = texture(sourceTexture, clamp(texCoord, halfTexel, sourceScale - halfTexel));
+}
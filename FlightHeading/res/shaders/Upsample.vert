@@ -0,0 +1,12 @@
+#version 330 core
+// Bufferless quad over the viewport that stretches the rendered corner of a RenderTarget across it
+
+out vec2 texCoord;
+uniform vec2 sourceScale; // Rendered size over the target's size
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	texCoord = corner * sourceScale;
+	gl_Position = vec4(corner * 2.f - 1.f, 0.f, 1.f);
+}
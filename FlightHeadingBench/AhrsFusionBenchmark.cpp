@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+#include "AhrsFusion.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <vector>
+
+void RunAhrsFusionBenchmark()
+{
+	Bench::Header("AhrsFusion (Madgwick MARG, 1 kHz rigs)");
+
+	// A second of pre-generated samples per rig pattern keeps sensor simulation out of the timing
+	constexpr uint PatternLength = 1000;
+	std::vector<ImuSample> Pattern(PatternLength);
+	for (uint i = 0; i < PatternLength; i++)
+	{
+		Pattern[i] = AhrsFusion::SimulateSample(HeadingMath::Wrap360(i * 0.01f), 5.f, -8.f, 10.f);
+	}
+
+	{
+		AhrsFilter Filter;
+		Filter.Reset(Pattern[0]);
+		constexpr uint Iterations = 4000000;
+		uint i = 0;
+		const double Ns = Bench::TimeNs(Iterations, [&]()
+		{
+			Filter.Update(Pattern[i++ % PatternLength], 0.001f);
+		});
+		Bench::DoNotOptimize(Filter.GetHeadingDegrees());
+		Bench::Report("Single stream, per sample", Ns);
+		std::printf("  %.2f M samples/s/core, %.0f rigs at 1 kHz\n", 1e3 / Ns, 1e6 / Ns);
+	}
+
+	const uint RigCounts[] = { 16, 256, 4096 };
+	for (const uint RigCount : RigCounts)
+	{
+		AhrsBatch Batch(RigCount);
+		std::vector<AhrsBatch::Samples> Ticks(16);
+		for (uint Tick = 0; Tick < Ticks.size(); Tick++)
+		{
+			Ticks[Tick].Resize(RigCount);
+			for (uint Rig = 0; Rig < RigCount; Rig++)
+			{
+				Ticks[Tick].Set(Rig, Pattern[(Rig * 37 + Tick) % PatternLength]);
+			}
+		}
+		Batch.Reset(Ticks[0]);
+
+		const uint Iterations = std::max(16u, 8000000 / RigCount);
+		uint Tick = 0;
+		const double NsPerTick = Bench::TimeNs(Iterations, [&]()
+		{
+			Batch.Update(Ticks[Tick++ % Ticks.size()], 0.001f);
+		});
+
+		std::vector<float> Headings(RigCount);
+		Batch.GetHeadingsDegrees(Headings.data());
+		Bench::DoNotOptimize(Headings[0]);
+
+		char Label[64];
+		std::snprintf(Label, sizeof(Label), "Batch of %u rigs, per sample", RigCount);
+		const double NsPerSample = NsPerTick / RigCount;
+		Bench::Report(Label, NsPerSample);
+		std::printf("  %.2f M samples/s/core, %.0f rigs at 1 kHz\n", 1e3 / NsPerSample, 1e6 / NsPerSample);
+	}
+}
@@ -0,0 +1,40 @@
+#include "Benchmark.h"
+#include <cstring>
+
+struct BenchmarkEntry
+{
+	const char* Name;
+	void (*Run)();
+};
+
+static const BenchmarkEntry Benchmarks[] =
+{
+	{ "spatial", &RunSpatialIndexBenchmark },
+	{ "codec", &RunHeadingCodecBenchmark },
+	{ "feed", &RunHeadingFeedBenchmark },
+	{ "arbiter", &RunHeadingArbiterBenchmark },
+	{ "ahrs", &RunAhrsFusionBenchmark },
+	{ "declination", &RunMagneticModelBenchmark },
+	{ "trace", &RunTraceBenchmark },
+	{ "transform", &RunTransformBenchmark },
+};
+
+// Usage: FlightHeadingBench [name...]. Runs every benchmark when no name is given.
+int main(int argc, char** argv)
+{
+	for (const BenchmarkEntry& Entry : Benchmarks)
+	{
+		bool Selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+		{
+			Selected |= std::strcmp(argv[i], Entry.Name) == 0;
+		}
+
+		if (Selected)
+		{
+			Entry.Run();
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+
+namespace Bench
+{
+	using Clock = std::chrono::steady_clock;
+
+	inline double SecondsSince(Clock::time_point Start)
+	{
+		return std::chrono::duration<double>(Clock::now() - Start).count();
+	}
+
+	// Runs Body Iterations times and returns the mean wall time of one iteration in nanoseconds
+	template<typename Fn>
+	double TimeNs(unsigned Iterations, Fn&& Body)
+	{
+		const Clock::time_point Start = Clock::now();
+		for (unsigned i = 0; i < Iterations; i++)
+		{
+			Body();
+		}
+		return SecondsSince(Start) * 1e9 / (Iterations ? Iterations : 1);
+	}
+
+	// Keeps the optimizer from discarding a computed result
+	template<typename T>
+	inline void DoNotOptimize(const T& Value)
+	{
+		static volatile char Sink;
+		Sink = *reinterpret_cast<const volatile char*>(&Value);
+		(void)Sink;
+	}
+
+	inline void Header(const char* Name)
+	{
+		std::printf("\n== %s ==\n", Name);
+	}
+
+	inline void Report(const char* Label, double NsPerOp)
+	{
+		if (NsPerOp >= 1e6)
+		{
+			std::printf("  %-40s %10.3f ms\n", Label, NsPerOp * 1e-6);
+		}
+		else if (NsPerOp >= 1e3)
+		{
+			std::printf("  %-40s %10.3f us\n", Label, NsPerOp * 1e-3);
+		}
+		else
+		{
+			std::printf("  %-40s %10.1f ns\n", Label, NsPerOp);
+		}
+	}
+}
+
+void RunSpatialIndexBenchmark();
+void RunHeadingCodecBenchmark();
+void RunHeadingFeedBenchmark();
+void RunHeadingArbiterBenchmark();
+void RunAhrsFusionBenchmark();
+void RunMagneticModelBenchmark();
+void RunTraceBenchmark();
+void RunTransformBenchmark();
@@ -0,0 +1,51 @@
+#include "Benchmark.h"
+#include "HeadingArbiter.h"
+#include "HeadingMath.h"
+#include <random>
+#include <vector>
+
+void RunHeadingArbiterBenchmark()
+{
+	Bench::Header("HeadingArbiter (median vote over timestamped sources)");
+
+	constexpr uint SampleCount = 1 << 20;
+	std::mt19937 Rng(7);
+	std::normal_distribution<float> Noise(0.f, 0.3f);
+	std::vector<float> Headings(SampleCount);
+	for (uint i = 0; i < SampleCount; i++)
+	{
+		Headings[i] = HeadingMath::Wrap360(i * 0.001f + Noise(Rng));
+	}
+
+	// Cost per sample must not depend on how fast samples arrive, only on the source count
+	for (uint SourceCount = 1; SourceCount <= HeadingArbiter::MaxSources; SourceCount++)
+	{
+		HeadingArbiter Arbiter(SourceCount);
+		uint i = 0;
+		const double Ns = Bench::TimeNs(SampleCount, [&]()
+		{
+			Arbiter.Submit(i % SourceCount, int64_t(i) * 100, Headings[i]);
+			i++;
+		});
+
+		char Label[64];
+		std::snprintf(Label, sizeof(Label), "Submit, %u sources", SourceCount);
+		Bench::Report(Label, Ns);
+	}
+
+	HeadingArbiter Arbiter(3);
+	for (uint i = 0; i < 3; i++)
+	{
+		Arbiter.Submit(i, 1000, 90.f);
+	}
+	int64_t NowUs = 1000;
+	Bench::Report("Load (render thread)", Bench::TimeNs(SampleCount, [&]()
+	{
+		Bench::DoNotOptimize(Arbiter.Load(NowUs++));
+	}));
+	std::printf("  %.1f M samples/s per core with 3 sources\n", 1e3 / Bench::TimeNs(SampleCount, [&]()
+	{
+		Arbiter.Submit(uint(NowUs) % 3, NowUs, Headings[uint(NowUs) % SampleCount]);
+		NowUs++;
+	}));
+}
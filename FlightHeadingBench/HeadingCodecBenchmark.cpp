@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+#include "HeadingCodec.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// 200 Hz samples with a little timestamp jitter, coordinated turns and sensor noise
+	void MakeFlight(uint Count, float NoiseDegrees, std::vector<int64_t>& Times, std::vector<float>& Headings)
+	{
+		std::mt19937 Rng(42);
+		std::normal_distribution<float> Noise(0.f, NoiseDegrees);
+		std::uniform_int_distribution<int> Jitter(-20, 20);
+		std::uniform_real_distribution<float> TurnRate(-3.f, 3.f);
+
+		Times.resize(Count);
+		Headings.resize(Count);
+		float Heading = 90.f;
+		float Rate = 0.f;
+		for (uint i = 0; i < Count; i++)
+		{
+			if (i % 6000 == 0)
+			{
+				Rate = (i / 6000) % 2 ? TurnRate(Rng) : 0.f;
+			}
+			Heading = HeadingMath::Wrap360(Heading + Rate * 0.005f);
+			Times[i] = int64_t(i) * 5000 + Jitter(Rng);
+			Headings[i] = HeadingMath::Wrap360(Heading + (NoiseDegrees > 0.f ? Noise(Rng) : 0.f));
+		}
+	}
+}
+
+void RunHeadingCodecBenchmark()
+{
+	Bench::Header("HeadingCodec (delta-of-delta + 16-bit binary angles)");
+
+	constexpr uint SampleCount = 200 * 3600 * 4; // Four hours at 200 Hz
+	constexpr double RawBytesPerSample = sizeof(int64_t) + sizeof(float);
+	const float NoiseLevels[] = { 0.f, 0.02f, 0.1f };
+
+	for (const float NoiseDegrees : NoiseLevels)
+	{
+		std::vector<int64_t> Times;
+		std::vector<float> Headings;
+		MakeFlight(SampleCount, NoiseDegrees, Times, Headings);
+		std::printf(" %u samples, heading noise %.2f deg\n", SampleCount, NoiseDegrees);
+
+		HeadingSeries Series;
+		Bench::Clock::time_point Start = Bench::Clock::now();
+		{
+			HeadingEncoder Encoder(Series);
+			for (uint i = 0; i < SampleCount; i++)
+			{
+				Encoder.Append(Times[i], Headings[i]);
+			}
+		}
+		const double EncodeSeconds = Bench::SecondsSince(Start);
+
+		std::vector<int64_t> DecodedTimes(SampleCount);
+		std::vector<float> DecodedHeadings(SampleCount);
+		Start = Bench::Clock::now();
+		uint64_t Offset = 0;
+		for (uint Block = 0; Block < Series.Blocks.size(); Block++)
+		{
+			HeadingDecoder::DecodeBlock(Series, Block, DecodedTimes.data() + Offset, DecodedHeadings.data() + Offset);
+			Offset += Series.Blocks[Block].Count;
+		}
+		const double DecodeSeconds = Bench::SecondsSince(Start);
+
+		float MaxError = 0.f;
+		bool TimesExact = true;
+		for (uint i = 0; i < SampleCount; i++)
+		{
+			MaxError = std::max(MaxError, std::fabs(HeadingMath::ShortestArc(Headings[i], DecodedHeadings[i])));
+			TimesExact &= DecodedTimes[i] == Times[i];
+		}
+
+		const double RawBytes = SampleCount * RawBytesPerSample;
+		std::printf("  %-40s %10.2f x (%.2f bits/sample)\n", "Compression ratio", RawBytes / Series.GetEncodedSize(), Series.GetEncodedSize() * 8.0 / SampleCount);
+		std::printf("  %-40s %10.3f GB/s\n", "Encode (raw bytes in)", RawBytes / EncodeSeconds * 1e-9);
+		std::printf("  %-40s %10.3f GB/s\n", "Decode (raw bytes out)", RawBytes / DecodeSeconds * 1e-9);
+		std::printf("  %-40s %10.4f deg, timestamps %s\n", "Max heading error", MaxError, TimesExact ? "exact" : "MISMATCH");
+
+		HeadingDecoder Decoder(Series);
+		std::mt19937 Rng(7);
+		std::uniform_int_distribution<int64_t> SeekTime(0, Times.back());
+		int64_t Time = 0;
+		float Heading = 0.f;
+		Bench::Report("Seek + first sample", Bench::TimeNs(1000, [&]()
+		{
+			Decoder.Seek(SeekTime(Rng));
+			Decoder.Next(Time, Heading);
+		}));
+		Bench::DoNotOptimize(Time);
+	}
+}
@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+#include "HeadingFeed.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const char* BenchFeedName = "FlightHeading.BenchFeed";
+}
+
+void RunHeadingFeedBenchmark()
+{
+	Bench::Header("HeadingFeed (shared memory seqlock)");
+
+	HeadingFeedWriter Writer;
+	HeadingFeedReader Reader;
+	if (!Writer.Create(BenchFeedName) || !Reader.Open(BenchFeedName))
+	{
+		std::printf("  Shared memory unavailable, skipped\n");
+		return;
+	}
+
+	constexpr uint Iterations = 2000000;
+	HeadingFeedSample Sample;
+	uint Counter = 0;
+
+	Bench::Report("Publish", Bench::TimeNs(Iterations, [&]()
+	{
+		Sample.HeadingDegrees = float(Counter++ % 360);
+		Writer.Publish(Sample);
+	}));
+
+	HeadingFeedSample Latest;
+	Reader.Read(0, Latest);
+	Bench::Report("Read, nothing new (per-frame poll)", Bench::TimeNs(Iterations, [&]()
+	{
+		Bench::DoNotOptimize(Reader.Read(0, Latest));
+	}));
+
+	Bench::Report("Publish + Read", Bench::TimeNs(Iterations, [&]()
+	{
+		Sample.HeadingDegrees = float(Counter++ % 360);
+		Writer.Publish(Sample);
+		Bench::DoNotOptimize(Reader.Read(0, Latest));
+	}));
+
+	// Cross-thread: a publisher at a fixed rate and a spinning reader measure publish-to-read
+	// latency. On a machine with fewer cores than threads this mostly measures the scheduler.
+	constexpr int64_t PublishPeriodUs = 100;
+	constexpr double RunSeconds = 1.0;
+	std::atomic<bool> Running(true);
+	std::vector<int64_t> LatenciesUs;
+	LatenciesUs.reserve(size_t(RunSeconds * 1e6 / PublishPeriodUs) + 16);
+
+	std::thread ReaderThread([&]()
+	{
+		HeadingFeedReader ThreadReader;
+		ThreadReader.Open(BenchFeedName);
+		HeadingFeedSample Received;
+		ThreadReader.Read(0, Received);
+		while (Running.load(std::memory_order_relaxed))
+		{
+			if (ThreadReader.Read(0, Received))
+			{
+				LatenciesUs.push_back(HeadingFeed::NowUs() - Received.TimeUs);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	const int64_t Start = HeadingFeed::NowUs();
+	uint64_t Published = 0;
+	for (int64_t Next = Start; Next - Start < int64_t(RunSeconds * 1e6); Next += PublishPeriodUs)
+	{
+		while (HeadingFeed::NowUs() < Next)
+		{
+			std::this_thread::yield();
+		}
+		Sample.TimeUs = HeadingFeed::NowUs();
+		Writer.Publish(Sample);
+		Published++;
+	}
+	Running = false;
+	ReaderThread.join();
+
+	std::sort(LatenciesUs.begin(), LatenciesUs.end());
+	auto Percentile = [&](double P) { return LatenciesUs.empty() ? 0.0 : double(LatenciesUs[size_t(P * (LatenciesUs.size() - 1))]); };
+	std::printf("  %llu published at %lld us intervals, %zu seen by a second thread\n",
+		(unsigned long long)Published, (long long)PublishPeriodUs, LatenciesUs.size());
+	std::printf("  Latency p50 %.0f us, p99 %.0f us, max %.0f us\n", Percentile(0.5), Percentile(0.99), Percentile(1.0));
+
+	// Closing the only writer removes the feed, unless an earlier run crashed with it open
+	Writer.Close();
+	HeadingFeedWriter::Remove(BenchFeedName);
+}
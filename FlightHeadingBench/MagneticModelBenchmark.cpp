@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+#include "MagneticModel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+void RunMagneticModelBenchmark()
+{
+	Bench::Header("MagneticModel (declination grid vs spherical harmonics)");
+
+	// Synthetic degree 12 coefficients with a WMM-like spectrum. Only for timing, the declinations are meaningless.
+	MagneticModel Model(2025.0);
+	std::mt19937 Random(7);
+	std::uniform_real_distribution<double> Unit(-1.0, 1.0);
+	Model.SetCoefficient(1, 0, -29350.0, 0.0, 12.0, 0.0);
+	Model.SetCoefficient(1, 1, -1410.0, 4545.0, 10.0, -21.0);
+	for (uint N = 2; N <= MagneticModel::MaxDegree; N++)
+	{
+		const double Scale = 3000.0 / (N * N);
+		for (uint M = 0; M <= N; M++)
+		{
+			Model.SetCoefficient(N, M, Scale * Unit(Random), M ? Scale * Unit(Random) : 0.0, 0.1 * Unit(Random), M ? 0.1 * Unit(Random) : 0.0);
+		}
+	}
+
+	constexpr uint TargetCount = 10000;
+	std::uniform_real_distribution<float> LatitudeRange(-80.f, 80.f), LongitudeRange(-180.f, 180.f), HeadingRange(0.f, 360.f);
+	std::vector<float> Latitudes(TargetCount), Longitudes(TargetCount), Magnetic(TargetCount), True(TargetCount);
+	for (uint i = 0; i < TargetCount; i++)
+	{
+		Latitudes[i] = LatitudeRange(Random);
+		Longitudes[i] = LongitudeRange(Random);
+		Magnetic[i] = HeadingRange(Random);
+	}
+
+	{
+		uint i = 0;
+		const double Ns = Bench::TimeNs(20000, [&]()
+		{
+			Bench::DoNotOptimize(Model.Declination(Latitudes[i % TargetCount], Longitudes[i % TargetCount], 0.0, 2026.5));
+			i++;
+		});
+		Bench::Report("Model evaluation, per query", Ns);
+	}
+
+	const std::string GridPath = "FlightHeadingBench.fhdg";
+	{
+		const Bench::Clock::time_point Start = Bench::Clock::now();
+		DeclinationGrid::Build(Model, 2026.5, 1.f, GridPath);
+		Bench::Report("Build 1 deg grid, 1 thread", Bench::SecondsSince(Start) * 1e9);
+	}
+	{
+		ThreadPool Pool;
+		const Bench::Clock::time_point Start = Bench::Clock::now();
+		DeclinationGrid::Build(Model, 2026.5, 1.f, GridPath, &Pool);
+		char Label[64];
+		std::snprintf(Label, sizeof(Label), "Build 1 deg grid, %u threads", Pool.GetThreadCount());
+		Bench::Report(Label, Bench::SecondsSince(Start) * 1e9);
+	}
+
+	DeclinationGrid Grid;
+	if (!Grid.Open(GridPath))
+	{
+		std::printf("  Could not open %s\n", GridPath.c_str());
+		return;
+	}
+
+	{
+		uint i = 0;
+		const double Ns = Bench::TimeNs(4000000, [&]()
+		{
+			Bench::DoNotOptimize(Grid.Lookup(Latitudes[i % TargetCount], Longitudes[i % TargetCount]));
+			i++;
+		});
+		Bench::Report("Grid lookup, per query", Ns);
+	}
+
+	{
+		const double Ns = Bench::TimeNs(400, [&]()
+		{
+			Grid.MagneticToTrue(Latitudes.data(), Longitudes.data(), Magnetic.data(), True.data(), TargetCount);
+		});
+		Bench::DoNotOptimize(True[0]);
+		Bench::Report("MagneticToTrue, 10k targets", Ns);
+	}
+
+	double MaxError = 0.0;
+	for (uint i = 0; i < 1000; i++)
+	{
+		const double Error = std::fabs(Grid.Lookup(Latitudes[i], Longitudes[i]) - Model.Declination(Latitudes[i], Longitudes[i], 0.0, 2026.5));
+		MaxError = std::max(MaxError, std::min(Error, 360.0 - Error));
+	}
+	std::printf("  Max grid error below 80 deg latitude (synthetic field): %.3f deg\n", MaxError);
+
+	Grid.Close();
+	std::remove(GridPath.c_str());
+}
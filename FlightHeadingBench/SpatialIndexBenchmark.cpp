@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+void RunSpatialIndexBenchmark()
+{
+	Bench::Header("SpatialIndex (uniform grid)");
+
+	constexpr float WorldSize = 1000.f;    // nm
+	constexpr float ViewportSize = 100.f;  // 1% of the world area
+	constexpr uint QueryCount = 1000;
+	const uint TargetCounts[] = { 10000, 100000, 1000000 };
+
+	std::mt19937 Rng(1234);
+	std::uniform_real_distribution<float> Position(0.f, WorldSize);
+	std::uniform_real_distribution<float> Drift(-0.05f, 0.05f);
+
+	for (const uint Count : TargetCounts)
+	{
+		std::vector<float> X(Count), Y(Count);
+		for (uint i = 0; i < Count; i++)
+		{
+			X[i] = Position(Rng);
+			Y[i] = Position(Rng);
+		}
+
+		std::vector<float> QueryX(QueryCount), QueryY(QueryCount);
+		for (uint i = 0; i < QueryCount; i++)
+		{
+			QueryX[i] = Position(Rng);
+			QueryY[i] = Position(Rng);
+		}
+
+		SpatialIndex Index;
+		std::printf(" %u targets\n", Count);
+
+		Bench::Report("Build", Bench::TimeNs(10, [&]() { Index.Build(X.data(), Y.data(), Count); }));
+
+		// One tick of movement, small enough that most targets stay in their cell
+		std::vector<float> MovedX(X), MovedY(Y);
+		for (uint i = 0; i < Count; i++)
+		{
+			MovedX[i] = std::min(std::max(X[i] + Drift(Rng), 0.f), WorldSize);
+			MovedY[i] = std::min(std::max(Y[i] + Drift(Rng), 0.f), WorldSize);
+		}
+		Bench::Report("Update (drifted tick)", Bench::TimeNs(10, [&]()
+		{
+			Index.Update(MovedX.data(), MovedY.data(), Count);
+			Index.Update(X.data(), Y.data(), Count);
+		}) * 0.5);
+		Bench::Report("Update (no cell change)", Bench::TimeNs(10, [&]() { Index.Update(X.data(), Y.data(), Count); }));
+
+		std::vector<uint> Result;
+		size_t Found = 0;
+		uint Query = 0;
+		Bench::Report("QueryRange (100x100 nm)", Bench::TimeNs(QueryCount, [&]()
+		{
+			Result.clear();
+			const float QX = QueryX[Query], QY = QueryY[Query];
+			Index.QueryRange(QX, QY, QX + ViewportSize, QY + ViewportSize, Result);
+			Found += Result.size();
+			Query = (Query + 1) % QueryCount;
+		}));
+		Bench::DoNotOptimize(Found);
+
+		Query = 0;
+		Bench::Report("QueryNearest (k = 8)", Bench::TimeNs(QueryCount, [&]()
+		{
+			Index.QueryNearest(QueryX[Query], QueryY[Query], 8, Result);
+			Found += Result.front();
+			Query = (Query + 1) % QueryCount;
+		}));
+		Bench::DoNotOptimize(Found);
+
+		// Reference point for the linear scan the index replaces
+		Query = 0;
+		Bench::Report("Linear nearest scan (k = 1)", Bench::TimeNs(20, [&]()
+		{
+			const float QX = QueryX[Query], QY = QueryY[Query];
+			float BestDist2 = 1e30f;
+			uint BestIndex = 0;
+			for (uint i = 0; i < Count; i++)
+			{
+				const float DX = X[i] - QX, DY = Y[i] - QY;
+				const float Dist2 = DX * DX + DY * DY;
+				if (Dist2 < BestDist2)
+				{
+					BestDist2 = Dist2;
+					BestIndex = i;
+				}
+			}
+			Found += BestIndex;
+			Query = (Query + 1) % QueryCount;
+		}));
+		Bench::DoNotOptimize(Found);
+	}
+}
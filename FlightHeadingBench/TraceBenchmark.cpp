@@ -0,0 +1,47 @@
+#include "Benchmark.h"
+#include "Trace.h"
+#include <cstdio>
+#include <string>
+
+void RunTraceBenchmark()
+{
+	Bench::Header("Trace (per scope event)");
+
+	// Fewer scopes than a thread buffer holds, so none is dropped
+	constexpr uint Iterations = 50000;
+	// Naming the thread allocates its buffer outside the timing
+	TRACE_THREAD("Main");
+
+	{
+		uint64_t Sum = 0;
+		const double Ns = Bench::TimeNs(Iterations, [&Sum]()
+		{
+			Sum += Trace::Now();
+		});
+		Bench::DoNotOptimize(Sum);
+		Bench::Report("Timestamp read (two per event)", Ns);
+	}
+
+	{
+		const double Ns = Bench::TimeNs(Iterations, []()
+		{
+			TRACE_SCOPE("Idle");
+		});
+		Bench::Report("TRACE_SCOPE, not recording", Ns);
+	}
+
+	Trace::Start();
+	{
+		const double Ns = Bench::TimeNs(Iterations, []()
+		{
+			TRACE_SCOPE("Recorded");
+		});
+		Bench::Report("TRACE_SCOPE, recording", Ns);
+	}
+
+	const std::string TracePath = "FlightHeadingBench.trace.json";
+	const Bench::Clock::time_point Start = Bench::Clock::now();
+	Trace::Stop(TracePath);
+	Bench::Report("Stop, write 50k events", Bench::SecondsSince(Start) * 1e9);
+	std::remove(TracePath.c_str());
+}
@@ -0,0 +1,138 @@
+#include "Benchmark.h"
+#include "Affine2D.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Unit quad corners, as drawn for every gauge and traffic symbol
+	const float CornerX[4] = { -1.f, -1.f, 1.f, 1.f };
+	const float CornerY[4] = { 1.f, -1.f, -1.f, 1.f };
+}
+
+void RunTransformBenchmark()
+{
+#if defined(GLM_FORCE_INTRINSICS)
+	Bench::Header("Transform (glm with intrinsics, aligned types)");
+#else
+	Bench::Header("Transform (glm scalar)");
+#endif
+
+	// Every symbol has its own heading, position and size; the output is its four screen corners
+	const uint SymbolCounts[] = { 64, 4096, 65536 };
+	for (const uint SymbolCount : SymbolCounts)
+	{
+		std::mt19937 Random(3);
+		std::uniform_real_distribution<float> Position(-1.f, 1.f), Heading(0.f, 6.2831853f), Size(0.01f, 0.05f);
+		std::vector<float> X(SymbolCount), Y(SymbolCount), Radians(SymbolCount), Scale(SymbolCount);
+		for (uint i = 0; i < SymbolCount; i++)
+		{
+			X[i] = Position(Random);
+			Y[i] = Position(Random);
+			Radians[i] = Heading(Random);
+			Scale[i] = Size(Random);
+		}
+		std::vector<float> OutX(SymbolCount * 4), OutY(SymbolCount * 4);
+		const uint Iterations = std::max(4u, 4000000 / SymbolCount);
+
+		const double Mat4Ns = Bench::TimeNs(Iterations, [&]()
+		{
+			for (uint i = 0; i < SymbolCount; i++)
+			{
+				glm::mat4 Model = glm::translate(glm::mat4(1.f), glm::vec3(X[i], Y[i], 0.f));
+				Model = glm::scale(Model, glm::vec3(Scale[i], Scale[i], 1.f));
+				Model = glm::rotate(Model, Radians[i], glm::vec3(0.f, 0.f, 1.f));
+				for (uint Corner = 0; Corner < 4; Corner++)
+				{
+					const glm::vec4 P = Model * glm::vec4(CornerX[Corner], CornerY[Corner], 0.f, 1.f);
+					OutX[i * 4 + Corner] = P.x;
+					OutY[i * 4 + Corner] = P.y;
+				}
+			}
+		}) / SymbolCount;
+		Bench::DoNotOptimize(OutX[0]);
+
+		const double AffineNs = Bench::TimeNs(Iterations, [&]()
+		{
+			for (uint i = 0; i < SymbolCount; i++)
+			{
+				const Affine2D Model = Affine2D::RotationScaleTranslation(Radians[i], Scale[i], X[i], Y[i]);
+				for (uint Corner = 0; Corner < 4; Corner++)
+				{
+					Model.Apply(CornerX[Corner], CornerY[Corner], OutX[i * 4 + Corner], OutY[i * 4 + Corner]);
+				}
+			}
+		}) / SymbolCount;
+		Bench::DoNotOptimize(OutX[0]);
+
+		// The sin/cos is shared by both, so also time the transforms alone with precomputed models
+		std::vector<glm::mat4> Mat4Models(SymbolCount);
+		std::vector<Affine2D> AffineModels(SymbolCount);
+		for (uint i = 0; i < SymbolCount; i++)
+		{
+			Mat4Models[i] = glm::rotate(glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(X[i], Y[i], 0.f)), glm::vec3(Scale[i], Scale[i], 1.f)), Radians[i], glm::vec3(0.f, 0.f, 1.f));
+			AffineModels[i] = Affine2D::RotationScaleTranslation(Radians[i], Scale[i], X[i], Y[i]);
+		}
+
+		const double Mat4ApplyNs = Bench::TimeNs(Iterations, [&]()
+		{
+			for (uint i = 0; i < SymbolCount; i++)
+			{
+				for (uint Corner = 0; Corner < 4; Corner++)
+				{
+					const glm::vec4 P = Mat4Models[i] * glm::vec4(CornerX[Corner], CornerY[Corner], 0.f, 1.f);
+					OutX[i * 4 + Corner] = P.x;
+					OutY[i * 4 + Corner] = P.y;
+				}
+			}
+		}) / SymbolCount;
+		Bench::DoNotOptimize(OutX[0]);
+
+		const double AffineApplyNs = Bench::TimeNs(Iterations, [&]()
+		{
+			for (uint i = 0; i < SymbolCount; i++)
+			{
+				for (uint Corner = 0; Corner < 4; Corner++)
+				{
+					AffineModels[i].Apply(CornerX[Corner], CornerY[Corner], OutX[i * 4 + Corner], OutY[i * 4 + Corner]);
+				}
+			}
+		}) / SymbolCount;
+		Bench::DoNotOptimize(OutX[0]);
+
+		char Label[64];
+		std::printf("  %u symbols, per symbol:\n", SymbolCount);
+		std::snprintf(Label, sizeof(Label), "  glm::mat4 build + 4 corners");
+		Bench::Report(Label, Mat4Ns);
+		std::snprintf(Label, sizeof(Label), "  Affine2D build + 4 corners");
+		Bench::Report(Label, AffineNs);
+		std::snprintf(Label, sizeof(Label), "  glm::mat4 4 corners");
+		Bench::Report(Label, Mat4ApplyNs);
+		std::snprintf(Label, sizeof(Label), "  Affine2D 4 corners");
+		Bench::Report(Label, AffineApplyNs);
+	}
+
+	{
+		// One gauge transform over a whole vertex batch
+		constexpr uint PointCount = 1 << 16;
+		std::vector<float> X(PointCount), Y(PointCount), OutX(PointCount), OutY(PointCount);
+		for (uint i = 0; i < PointCount; i++)
+		{
+			X[i] = float(i % 256) / 128.f - 1.f;
+			Y[i] = float(i / 256) / 128.f - 1.f;
+		}
+		Affine2D Model = Affine2D::RotationScaleTranslation(0.7f, 0.5f, 0.1f, -0.2f);
+		const double Ns = Bench::TimeNs(400, [&]()
+		{
+			Model.Apply(X.data(), Y.data(), OutX.data(), OutY.data(), PointCount);
+			Bench::DoNotOptimize(OutX[PointCount - 1]);
+			Model.Tx += 1e-6f;
+		}) / (PointCount / 1000.0);
+		Bench::DoNotOptimize(OutX[0]);
+		Bench::Report("Affine2D batch, per 1000 points (SoA)", Ns);
+	}
+}
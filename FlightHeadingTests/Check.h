@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdio>
+
+// Assertions for the ctest executables: a failed check is printed and counted, and main returns
+// nonzero when any failed so ctest reports the test
+namespace Check
+{
+	inline int& Failures()
+	{
+		static int Count = 0;
+		return Count;
+	}
+}
+
+#define CHECK(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); \
+			Check::Failures()++; \
+		} \
+	} while (0)
@@ -0,0 +1,109 @@
+#include "Check.h"
+#include "HeadingCodec.h"
+#include "HeadingMath.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	// Offsets in a log file: the 8 byte file header, then the first block's header of TimeBytes,
+	// AngleBytes, FirstTime, FirstAngle and Count
+	constexpr size_t FirstTimeBytes = 8;
+	constexpr size_t FirstAngleBytes = 12;
+	constexpr size_t FirstCount = 26;
+	constexpr float HeadingStep = 360.f / 65536.f;
+
+	std::vector<uchar> ReadFile(const char* Path)
+	{
+		std::ifstream Stream(Path, std::ios::binary);
+		return std::vector<uchar>(std::istreambuf_iterator<char>(Stream), std::istreambuf_iterator<char>());
+	}
+
+	bool ReadsIndex(const std::vector<uchar>& File)
+	{
+		std::vector<HeadingBlockInfo> Blocks;
+		return ReadHeadingLogIndex(File.data(), File.size(), Blocks);
+	}
+
+	template<typename T>
+	std::vector<uchar> Patched(std::vector<uchar> File, size_t Offset, T Value)
+	{
+		std::memcpy(File.data() + Offset, &Value, sizeof(Value));
+		return File;
+	}
+}
+
+int main()
+{
+	// Irregular sample spacing with a repeated timestamp and a long gap, and a heading swinging
+	// back and forth across north
+	std::vector<int64_t> SourceTimes;
+	std::vector<float> SourceHeadings;
+	int64_t Time = 1700000000000000;
+	for (uint i = 0; i < 200; i++)
+	{
+		Time += i == 60 ? 0 : (i == 130 ? 5000000 : 20000 + int64_t((i * 7919) % 13) * 100 - 600);
+		SourceTimes.push_back(Time);
+		SourceHeadings.push_back(HeadingMath::Wrap360(355.f + 15.f * std::sin(i * 0.1f)));
+	}
+
+	HeadingSeries Series;
+	{
+		HeadingEncoder Encoder(Series, 64);
+		for (uint i = 0; i < 200; i++)
+		{
+			Encoder.Append(SourceTimes[i], SourceHeadings[i]);
+		}
+	}
+	const char* Path = "HeadingCodecTest.fhlog";
+	CHECK(SaveHeadingLog(Path, Series));
+	const std::vector<uchar> File = ReadFile(Path);
+
+	// The intact file reads and decodes to what was written
+	std::vector<HeadingBlockInfo> Blocks;
+	CHECK(ReadHeadingLogIndex(File.data(), File.size(), Blocks));
+	CHECK(Blocks.size() == 4);
+	uint Samples = 0;
+	for (const HeadingBlockInfo& Block : Blocks)
+	{
+		std::vector<int64_t> Times(Block.Count);
+		std::vector<float> Headings(Block.Count);
+		CHECK(HeadingDecoder::DecodeBlock(File.data() + Block.ByteOffset, Times.data(), Headings.data()) == Block.Count);
+		CHECK(Times.front() == Block.FirstTime);
+		for (uint i = 0; i < Block.Count && Samples + i < SourceTimes.size(); i++)
+		{
+			CHECK(Times[i] == SourceTimes[Samples + i]);
+			CHECK(std::fabs(HeadingMath::ShortestArc(SourceHeadings[Samples + i], Headings[i])) <= HeadingStep);
+		}
+		Samples += Block.Count;
+	}
+	CHECK(Samples == 200);
+
+	// A block header that disagrees with the index, or claims more bytes than the block has
+	CHECK(!ReadsIndex(Patched(File, FirstCount, uint32_t(0xFFFF))));
+	CHECK(!ReadsIndex(Patched(File, FirstCount, uint32_t(0))));
+	CHECK(!ReadsIndex(Patched(File, FirstTimeBytes, uint32_t(0xFFFFFFFF))));
+	CHECK(!ReadsIndex(Patched(File, FirstAngleBytes, uint32_t(100000))));
+
+	// Index entries pointing into the wrong place
+	const size_t IndexOffset = File.size() - 24 - Blocks.size() * sizeof(HeadingBlockInfo);
+	const size_t SecondOffset = IndexOffset + sizeof(HeadingBlockInfo) + offsetof(HeadingBlockInfo, ByteOffset);
+	CHECK(!ReadsIndex(Patched(File, SecondOffset, uint64_t(File.size()))));
+	CHECK(!ReadsIndex(Patched(File, SecondOffset, uint64_t(Blocks[1].ByteOffset + 1))));
+	CHECK(!ReadsIndex(Patched(File, SecondOffset, uint64_t(4))));
+	CHECK(!ReadsIndex(Patched(File, IndexOffset + offsetof(HeadingBlockInfo, Count), uint32_t(1000))));
+
+	// Footers with a block count or index offset that cannot fit
+	CHECK(!ReadsIndex(Patched(File, File.size() - 16, uint64_t(1) << 60)));
+	CHECK(!ReadsIndex(Patched(File, File.size() - 24, uint64_t(0))));
+
+	// Truncated
+	CHECK(!ReadsIndex(std::vector<uchar>(File.begin(), File.end() - 1)));
+	CHECK(!ReadsIndex(std::vector<uchar>(File.begin(), File.begin() + 16)));
+
+	return Check::Failures() == 0 ? 0 : 1;
+}
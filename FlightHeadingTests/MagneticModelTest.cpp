@@ -0,0 +1,144 @@
+#include "Check.h"
+#include "HeadingMath.h"
+#include "MagneticModel.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	// WMM2020 through degree 3, in the WMM.COF layout
+	const char* const Coefficients =
+		"    2020.0            WMM-2020        12/10/2019\n"
+		"  1  0  -29404.5       0.0        6.7        0.0\n"
+		"  1  1   -1450.7    4652.9        7.7      -25.1\n"
+		"  2  0   -2500.0       0.0      -11.5        0.0\n"
+		"  2  1    2982.0   -2991.6       -7.1      -30.2\n"
+		"  2  2    1676.8    -734.8       -2.2      -23.9\n"
+		"  3  0    1363.9       0.0        2.8        0.0\n"
+		"  3  1   -2381.0     -82.2       -6.2        5.7\n"
+		"  3  2    1236.2     241.8        3.4       -1.0\n"
+		"  3  3     525.7    -542.9      -12.0        1.1\n"
+		"999999999999999999999999999999999999999999999999\n"
+		"999999999999999999999999999999999999999999999999\n";
+
+	// Computed independently from the same coefficients: central differences of the scalar
+	// potential, with the Legendre functions written out in closed form
+	struct ReferencePoint
+	{
+		double Latitude, Longitude, AltitudeKm, DecimalYear;
+		double North, East, Down, Declination;
+	};
+
+	const ReferencePoint ReferencePoints[] =
+	{
+		{ 0.0, 0.0, 0.0, 2020.0, 23819.967, -2140.002, -12633.278, -5.13371 },
+		{ 47.45, -122.31, 0.0, 2022.5, 16594.683, 4736.755, 46001.272, 15.93076 },
+		{ -33.9, 151.2, 10.0, 2021.25, 24534.500, 5531.452, -52959.968, 12.70525 },
+		{ 71.0, -156.8, 0.0, 2024.0, 11914.455, 1798.661, 53880.369, 8.58481 },
+		{ -75.0, 120.0, 35.0, 2020.0, -9345.594, -5182.132, -55954.171, -150.99163 },
+		{ 10.0, -179.5, 0.0, 2023.0, 32344.275, 3687.413, 8384.921, 6.50393 },
+	};
+
+	constexpr double FieldToleranceNT = 0.01;
+	constexpr float DeclinationTolerance = 1e-3f;
+	constexpr double GridYear = 2022.0;
+
+	bool Near(float A, float B, float Tolerance)
+	{
+		return std::fabs(HeadingMath::ShortestArc(A, B)) <= Tolerance;
+	}
+}
+
+int main()
+{
+	const char* ModelPath = "MagneticModelTest.cof";
+	{
+		std::ofstream Stream(ModelPath, std::ios::trunc);
+		Stream << Coefficients;
+	}
+
+	MagneticModel Model;
+	CHECK(Model.Load(ModelPath));
+	CHECK(Model.GetEpoch() == 2020.0);
+	CHECK(Model.GetName() == "WMM-2020");
+
+	// Field components, secular variation and altitude against the reference
+	for (const ReferencePoint& Point : ReferencePoints)
+	{
+		const MagneticField Field = Model.Evaluate(Point.Latitude, Point.Longitude, Point.AltitudeKm, Point.DecimalYear);
+		CHECK(std::fabs(Field.North - Point.North) < FieldToleranceNT);
+		CHECK(std::fabs(Field.East - Point.East) < FieldToleranceNT);
+		CHECK(std::fabs(Field.Down - Point.Down) < FieldToleranceNT);
+		CHECK(Near(Model.Declination(Point.Latitude, Point.Longitude, Point.AltitudeKm, Point.DecimalYear), float(Point.Declination), DeclinationTolerance));
+	}
+
+	const char* GridPath = "MagneticModelTest.fhdg";
+	CHECK(DeclinationGrid::Build(Model, GridYear, 1.f, GridPath));
+	DeclinationGrid Grid;
+	CHECK(Grid.Open(GridPath));
+
+	// Grid points are stored values, and a smooth region blends close to the model
+	for (int Latitude = -90; Latitude <= 90; Latitude += 15)
+	{
+		for (int Longitude = -180; Longitude <= 180; Longitude += 30)
+		{
+			CHECK(Near(Grid.Lookup(float(Latitude), float(Longitude)), Model.Declination(Latitude, Longitude, 0.0, GridYear), DeclinationTolerance));
+		}
+	}
+	CHECK(Near(Grid.Lookup(47.45f, -122.31f), Model.Declination(47.45, -122.31, 0.0, GridYear), 0.05f));
+
+	// Longitudes wrap: both ends of the row hold the same meridian, and anything beyond them
+	// reads the grid from the other side
+	for (float Latitude : { -85.5f, -40.f, 0.f, 52.25f, 88.f })
+	{
+		CHECK(Near(Grid.Lookup(Latitude, 180.f), Grid.Lookup(Latitude, -180.f), DeclinationTolerance));
+		CHECK(Near(Grid.Lookup(Latitude, 200.f), Grid.Lookup(Latitude, -160.f), DeclinationTolerance));
+		CHECK(Near(Grid.Lookup(Latitude, -181.5f), Grid.Lookup(Latitude, 178.5f), DeclinationTolerance));
+		CHECK(Near(Grid.Lookup(Latitude, 540.f), Grid.Lookup(Latitude, 180.f), DeclinationTolerance));
+		CHECK(Near(Grid.Lookup(Latitude, 179.9f), Grid.Lookup(Latitude, -179.9f), 0.5f));
+	}
+
+	// Near the magnetic poles declination crosses +-180 inside a cell. The blend must stay
+	// between the corners instead of averaging them to around 0.
+	uint SeamCells = 0;
+	for (int Row = 0; Row < 180; Row++)
+	{
+		for (int Column = 0; Column < 360; Column++)
+		{
+			const double Latitude = -90.0 + Row, Longitude = -180.0 + Column;
+			const float Corners[4] =
+			{
+				Model.Declination(Latitude, Longitude, 0.0, GridYear),
+				Model.Declination(Latitude, Longitude + 1.0, 0.0, GridYear),
+				Model.Declination(Latitude + 1.0, Longitude, 0.0, GridYear),
+				Model.Declination(Latitude + 1.0, Longitude + 1.0, 0.0, GridYear),
+			};
+			const float Highest = *std::max_element(Corners, Corners + 4);
+			const float Lowest = *std::min_element(Corners, Corners + 4);
+			float Spread = 0.f;
+			for (float A : Corners)
+			{
+				for (float B : Corners)
+				{
+					Spread = std::max(Spread, std::fabs(HeadingMath::ShortestArc(A, B)));
+				}
+			}
+			if (Highest < 90.f || Lowest > -90.f || Spread > 90.f)
+			{
+				continue;
+			}
+
+			SeamCells++;
+			const float Blended = Grid.Lookup(float(Latitude + 0.5), float(Longitude + 0.5));
+			CHECK(Blended > -180.f && Blended <= 180.f);
+			for (float Corner : Corners)
+			{
+				CHECK(Near(Blended, Corner, Spread + DeclinationTolerance));
+			}
+		}
+	}
+	CHECK(SeamCells > 0);
+
+	return Check::Failures() == 0 ? 0 : 1;
+}
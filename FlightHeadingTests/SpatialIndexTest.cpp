@@ -0,0 +1,98 @@
+#include "Check.h"
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	std::vector<uint> BruteForceRange(const std::vector<float>& X, const std::vector<float>& Y, float MinX, float MinY, float MaxX, float MaxY)
+	{
+		std::vector<uint> Result;
+		for (uint i = 0; i < X.size(); i++)
+		{
+			if (X[i] >= MinX && X[i] <= MaxX && Y[i] >= MinY && Y[i] <= MaxY)
+			{
+				Result.push_back(i);
+			}
+		}
+		return Result;
+	}
+
+	void CheckRange(const SpatialIndex& Index, const std::vector<float>& X, const std::vector<float>& Y, float MinX, float MinY, float MaxX, float MaxY)
+	{
+		std::vector<uint> Result;
+		Index.QueryRange(MinX, MinY, MaxX, MaxY, Result);
+		std::sort(Result.begin(), Result.end());
+		CHECK(Result == BruteForceRange(X, Y, MinX, MinY, MaxX, MaxY));
+	}
+}
+
+int main()
+{
+	// One target per unit on a 10x10 grid, one per cell
+	std::vector<float> X, Y;
+	for (uint Row = 0; Row < 10; Row++)
+	{
+		for (uint Column = 0; Column < 10; Column++)
+		{
+			X.push_back(float(Column));
+			Y.push_back(float(Row));
+		}
+	}
+	SpatialIndex Index(1.f);
+	Index.Build(X.data(), Y.data(), uint(X.size()));
+
+	// Outside the grid on each side
+	CheckRange(Index, X, Y, -100.f, 5.f, -50.f, 6.f);
+	CheckRange(Index, X, Y, 50.f, 5.f, 100.f, 6.f);
+	CheckRange(Index, X, Y, 2.f, -100.f, 3.f, -50.f);
+	CheckRange(Index, X, Y, 2.f, 50.f, 3.f, 100.f);
+	CheckRange(Index, X, Y, -100.f, -100.f, -50.f, -50.f);
+	CheckRange(Index, X, Y, 50.f, 50.f, 100.f, 100.f);
+
+	// Across the edges and corners, and around the whole grid
+	CheckRange(Index, X, Y, -5.f, 2.f, 1.5f, 4.f);
+	CheckRange(Index, X, Y, 7.5f, 2.f, 20.f, 4.f);
+	CheckRange(Index, X, Y, 3.f, -5.f, 4.f, 0.5f);
+	CheckRange(Index, X, Y, 3.f, 8.5f, 4.f, 20.f);
+	CheckRange(Index, X, Y, -5.f, -5.f, 0.f, 0.f);
+	CheckRange(Index, X, Y, 9.f, 9.f, 15.f, 15.f);
+	CheckRange(Index, X, Y, -1000.f, -1000.f, 1000.f, 1000.f);
+
+	// Bounds far past the int range, and NaN, which no target is inside
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	CheckRange(Index, X, Y, -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+	CheckRange(Index, X, Y, -FLT_MAX, 2.f, 4.5f, FLT_MAX);
+	CheckRange(Index, X, Y, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+	CheckRange(Index, X, Y, -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+	CheckRange(Index, X, Y, NaN, 2.f, 4.f, 4.f);
+	CheckRange(Index, X, Y, 2.f, 2.f, NaN, NaN);
+
+	// Inside, and an empty rectangle
+	CheckRange(Index, X, Y, 2.5f, 3.5f, 6.5f, 7.5f);
+	CheckRange(Index, X, Y, 4.f, 4.f, 4.f, 4.f);
+	CheckRange(Index, X, Y, 6.f, 4.f, 5.f, 4.f);
+
+	// The same after targets moved outward past the built bounds
+	for (float& Value : X)
+	{
+		Value = Value * 1.05f - 0.2f;
+	}
+	Index.Update(X.data(), Y.data(), uint(X.size()));
+	CheckRange(Index, X, Y, -100.f, 5.f, -50.f, 6.f);
+	CheckRange(Index, X, Y, -5.f, 2.f, 1.5f, 4.f);
+	CheckRange(Index, X, Y, 7.5f, 2.f, 20.f, 4.f);
+	CheckRange(Index, X, Y, -1000.f, -1000.f, 1000.f, 1000.f);
+
+	std::vector<uint> Nearest;
+	Index.QueryNearest(-30.f, 4.f, 3, Nearest);
+	CHECK(Nearest.size() == 3);
+	CHECK(!Nearest.empty() && X[Nearest[0]] == X[40] && Y[Nearest[0]] == 4.f);
+	// Every distance overflows from that far out, so only the count is defined
+	Index.QueryNearest(-FLT_MAX, FLT_MAX, 1, Nearest);
+	CHECK(Nearest.size() == 1);
+
+	return Check::Failures() == 0 ? 0 : 1;
+}
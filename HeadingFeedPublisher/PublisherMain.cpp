@@ -0,0 +1,217 @@
+#include "AhrsFusion.h"
+#include "HeadingCodec.h"
+#include "HeadingFeed.h"
+#include "HeadingMath.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stand-in for the simulator: publishes a synthetic turning heading, replays a heading log in real
+// time, or fuses simulated raw IMU samples of a tilted rig into a heading, into the shared-memory
+// heading feed.
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: HeadingFeedPublisher [options]\n"
+			"Options:\n"
+			"  --rate HZ            Publish rate (default 100, 1000 with --imu)\n"
+			"  --heading DEG        Initial heading (default 0)\n"
+			"  --turn-rate DEG/S    Constant rate of turn (default 3)\n"
+			"  --log FILE           Replay a heading log (.fhlog) instead of turning\n"
+			"  --imu                Derive the heading from noisy raw gyro/accel/mag samples\n"
+			"  --source N           Feed slot to publish in, 0-%u (default 0)\n"
+			"  --bias DEG           Constant error added to every heading (default 0)\n"
+			"  --seconds N          Stop after N seconds (default: run until interrupted)\n"
+			"  --name NAME          Feed name (default %s)\n", HeadingFeed::MaxSources - 1, HeadingFeed::DefaultName);
+	}
+
+	// Set on Ctrl+C or SIGTERM, so the writer closes and the last publisher out removes the feed
+	volatile std::sig_atomic_t StopRequested = 0;
+
+	void RequestStop(int)
+	{
+		StopRequested = 1;
+	}
+
+	void SleepUntil(int64_t TimeUs)
+	{
+		const int64_t Remaining = TimeUs - HeadingFeed::NowUs();
+		if (Remaining > 0)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(Remaining));
+		}
+	}
+
+	int ReplayLog(HeadingFeedWriter& Writer, const std::string& Path, double Seconds, uint Source, float Bias)
+	{
+		MappedFile File;
+		std::vector<HeadingBlockInfo> Blocks;
+		if (!File.Open(Path) || !ReadHeadingLogIndex(File.GetData(), File.GetSize(), Blocks) || Blocks.empty())
+		{
+			std::printf("%s is not a heading log\n", Path.c_str());
+			return 1;
+		}
+
+		std::vector<int64_t> Times;
+		std::vector<float> Headings;
+		const int64_t LogStart = Blocks.front().FirstTime;
+		const int64_t WallStart = HeadingFeed::NowUs();
+		float Previous = -1.f;
+		int64_t PreviousTime = 0;
+		uint64_t Published = 0;
+
+		for (const HeadingBlockInfo& Block : Blocks)
+		{
+			Times.resize(Block.Count);
+			Headings.resize(Block.Count);
+			const uint Count = HeadingDecoder::DecodeBlock(File.GetData() + Block.ByteOffset, Times.data(), Headings.data());
+			for (uint i = 0; i < Count; i++)
+			{
+				const int64_t Offset = Times[i] - LogStart;
+				if (StopRequested || (Seconds > 0.0 && Offset > int64_t(Seconds * 1e6)))
+				{
+					std::printf("Published %llu samples\n", (unsigned long long)Published);
+					return 0;
+				}
+				SleepUntil(WallStart + Offset);
+
+				HeadingFeedSample Sample;
+				Sample.TimeUs = HeadingFeed::NowUs();
+				Sample.HeadingDegrees = HeadingMath::Wrap360(Headings[i] + Bias);
+				Sample.RateOfTurn = Previous >= 0.f && Times[i] > PreviousTime
+					? HeadingMath::ShortestArc(Previous, Headings[i]) / float((Times[i] - PreviousTime) * 1e-6) : 0.f;
+				Sample.SourceID = Source;
+				Writer.Publish(Sample);
+
+				Previous = Headings[i];
+				PreviousTime = Times[i];
+				Published++;
+			}
+		}
+
+		std::printf("Published %llu samples\n", (unsigned long long)Published);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	double Rate = 0.0;
+	bool Imu = false;
+	float Heading = 0.f;
+	float TurnRate = 3.f;
+	double Seconds = 0.0;
+	uint Source = 0;
+	float Bias = 0.f;
+	std::string LogPath;
+	std::string Name = HeadingFeed::DefaultName;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool HasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--rate") == 0 && HasValue)
+		{
+			Rate = std::max(std::atof(argv[++i]), 1.0);
+		}
+		else if (std::strcmp(argv[i], "--heading") == 0 && HasValue)
+		{
+			Heading = HeadingMath::Wrap360(float(std::atof(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--turn-rate") == 0 && HasValue)
+		{
+			TurnRate = float(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--log") == 0 && HasValue)
+		{
+			LogPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--imu") == 0)
+		{
+			Imu = true;
+		}
+		else if (std::strcmp(argv[i], "--source") == 0 && HasValue)
+		{
+			Source = std::min(uint(std::atoi(argv[++i])), HeadingFeed::MaxSources - 1);
+		}
+		else if (std::strcmp(argv[i], "--bias") == 0 && HasValue)
+		{
+			Bias = float(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--seconds") == 0 && HasValue)
+		{
+			Seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--name") == 0 && HasValue)
+		{
+			Name = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	HeadingFeedWriter Writer;
+	if (!Writer.Create(Name))
+	{
+		return 1;
+	}
+	std::printf("Publishing source %u on %s\n", Source, Name.c_str());
+	std::signal(SIGINT, RequestStop);
+	std::signal(SIGTERM, RequestStop);
+
+	if (!LogPath.empty())
+	{
+		return ReplayLog(Writer, LogPath, Seconds, Source, Bias);
+	}
+
+	if (Rate <= 0.0)
+	{
+		Rate = Imu ? 1000.0 : 100.0;
+	}
+
+	// The rig sits tilted on a turntable; its sensors see that attitude plus noise
+	std::mt19937 Rng(Source + 1);
+	std::normal_distribution<float> GyroNoise(0.f, 0.002f);
+	std::normal_distribution<float> VectorNoise(0.f, 0.01f);
+	AhrsFilter Fusion;
+
+	const int64_t PeriodUs = int64_t(1e6 / Rate);
+	const int64_t Start = HeadingFeed::NowUs();
+	for (uint64_t Tick = 0; !StopRequested && (Seconds <= 0.0 || Tick * PeriodUs < uint64_t(Seconds * 1e6)); Tick++)
+	{
+		SleepUntil(Start + int64_t(Tick) * PeriodUs);
+
+		HeadingFeedSample Sample;
+		Sample.TimeUs = HeadingFeed::NowUs();
+		Sample.HeadingDegrees = HeadingMath::Wrap360(Heading + Bias + TurnRate * float(Tick * PeriodUs * 1e-6));
+		Sample.RateOfTurn = TurnRate;
+		Sample.SourceID = Source;
+
+		if (Imu)
+		{
+			ImuSample Raw = AhrsFusion::SimulateSample(Sample.HeadingDegrees, 4.f, -6.f, TurnRate);
+			for (int Axis = 0; Axis < 3; Axis++)
+			{
+				Raw.Gyro[Axis] += GyroNoise(Rng);
+				Raw.Accel[Axis] += VectorNoise(Rng);
+				Raw.Mag[Axis] += VectorNoise(Rng);
+			}
+			Fusion.Update(Raw, float(PeriodUs * 1e-6));
+			Sample.HeadingDegrees = Fusion.GetHeadingDegrees();
+		}
+		Writer.Publish(Sample);
+	}
+	return 0;
+}
@@ -0,0 +1,206 @@
+#include "FlightLogAnalysis.h"
+#include "HeadingMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr uint MaxWarmupBlocks = 64;
+
+	inline uint64_t CountTurn(float Degrees, const AnalysisSettings& Settings)
+	{
+		return std::fabs(Degrees) >= Settings.MinTurnDegrees ? 1 : 0;
+	}
+}
+
+LogStats LogStats::Merge(const LogStats& Left, const LogStats& Right, const AnalysisSettings& Settings)
+{
+	if (Left.Samples == 0)
+	{
+		return Right;
+	}
+	if (Right.Samples == 0)
+	{
+		return Left;
+	}
+
+	LogStats Out = Left;
+	Out.Accumulate(Right);
+
+	if (Left.AllTurning && Right.AllTurning)
+	{
+		Out.PrefixDegrees = Out.SuffixDegrees = Left.PrefixDegrees + Right.PrefixDegrees;
+		return Out;
+	}
+
+	Out.AllTurning = false;
+	Out.HasPrefixRun = Left.HasPrefixRun;
+	Out.PrefixDegrees = Left.PrefixDegrees;
+	Out.HasSuffixRun = Right.HasSuffixRun;
+	Out.SuffixDegrees = Right.SuffixDegrees;
+
+	const float Joined = (Left.HasSuffixRun ? Left.SuffixDegrees : 0.f) + (Right.HasPrefixRun ? Right.PrefixDegrees : 0.f);
+	if (Left.AllTurning)
+	{
+		// The whole left span plus whatever continues on the right is still open at the start
+		Out.PrefixDegrees = Joined;
+	}
+	else if (Right.AllTurning)
+	{
+		Out.HasSuffixRun = true;
+		Out.SuffixDegrees = Joined;
+	}
+	else if (Left.HasSuffixRun || Right.HasPrefixRun)
+	{
+		Out.Turns += CountTurn(Joined, Settings);
+	}
+
+	return Out;
+}
+
+void LogStats::Finish(const AnalysisSettings& Settings)
+{
+	if (AllTurning)
+	{
+		Turns += CountTurn(PrefixDegrees, Settings);
+	}
+	else
+	{
+		Turns += HasPrefixRun ? CountTurn(PrefixDegrees, Settings) : 0;
+		Turns += HasSuffixRun ? CountTurn(SuffixDegrees, Settings) : 0;
+	}
+
+	AllTurning = HasPrefixRun = HasSuffixRun = false;
+	PrefixDegrees = SuffixDegrees = 0.f;
+}
+
+void LogStats::Accumulate(const LogStats& Other)
+{
+	Samples += Other.Samples;
+	Seconds += Other.Seconds;
+	Turns += Other.Turns;
+	MaxRateOfTurn = std::max(MaxRateOfTurn, Other.MaxRateOfTurn);
+	OffCourseSeconds += Other.OffCourseSeconds;
+	for (uint Bin = 0; Bin < HistogramBins; Bin++)
+	{
+		Histogram[Bin] += Other.Histogram[Bin];
+	}
+}
+
+LogStats AnalyzeLogSpan(const uchar* LogData, const std::vector<HeadingBlockInfo>& Blocks, uint FirstBlock, uint BlockCount, const AnalysisSettings& Settings)
+{
+	LogStats Stats;
+	if (BlockCount == 0)
+	{
+		return Stats;
+	}
+
+	const int64_t WindowUs = int64_t(Settings.RateWindowSeconds * 1e6);
+	const int64_t MaxGapUs = int64_t(Settings.MaxSampleGapSeconds * 1e6);
+
+	uint WarmupBlock = FirstBlock;
+	while (WarmupBlock > 0 && FirstBlock - WarmupBlock < MaxWarmupBlocks && Blocks[WarmupBlock].FirstTime > Blocks[FirstBlock].FirstTime - WindowUs)
+	{
+		WarmupBlock--;
+	}
+
+	size_t Total = 0, Owned = 0;
+	for (uint Block = WarmupBlock; Block < FirstBlock + BlockCount; Block++)
+	{
+		Total += Blocks[Block].Count;
+		Owned += Block < FirstBlock ? Blocks[Block].Count : 0;
+	}
+
+	thread_local std::vector<int64_t> Times;
+	thread_local std::vector<float> Headings;
+	Times.resize(Total);
+	Headings.resize(Total);
+
+	size_t Offset = 0;
+	for (uint Block = WarmupBlock; Block < FirstBlock + BlockCount; Block++)
+	{
+		Offset += HeadingDecoder::DecodeBlock(LogData + Blocks[Block].ByteOffset, Times.data() + Offset, Headings.data() + Offset);
+	}
+
+	size_t WindowStart = 0;  // First sample after the latest gap
+	size_t WindowTail = 0;   // Oldest sample inside the rate-of-turn window
+	bool InRun = false;
+	bool RunFromStart = false;
+	float RunDegrees = 0.f;
+
+	for (size_t i = 0; i < Total; i++)
+	{
+		const int64_t DeltaUs = i > 0 ? Times[i] - Times[i - 1] : 0;
+		const bool Gap = DeltaUs > MaxGapUs;
+		if (Gap)
+		{
+			WindowStart = i;
+		}
+
+		WindowTail = std::max(WindowTail, WindowStart);
+		while (Times[i] - Times[WindowTail] > WindowUs)
+		{
+			WindowTail++;
+		}
+
+		if (i < Owned)
+		{
+			continue;
+		}
+
+		// Too short a baseline right after the start of a log or a gap only measures noise
+		const int64_t SpanUs = Times[i] - Times[WindowTail];
+		const float Rate = SpanUs * 2 >= WindowUs && SpanUs > 0 ? HeadingMath::ShortestArc(Headings[WindowTail], Headings[i]) / float(SpanUs * 1e-6) : 0.f;
+		const float Delta = i > WindowStart ? HeadingMath::ShortestArc(Headings[i - 1], Headings[i]) : 0.f;
+		const double DeltaSeconds = Gap ? 0.0 : DeltaUs * 1e-6;
+
+		Stats.Samples++;
+		Stats.Seconds += DeltaSeconds;
+		Stats.MaxRateOfTurn = std::max(Stats.MaxRateOfTurn, std::fabs(Rate));
+		Stats.Histogram[std::min(uint(Headings[i] * (LogStats::HistogramBins / 360.f)), LogStats::HistogramBins - 1)]++;
+
+		if (Settings.HasCourse && std::fabs(HeadingMath::ShortestArc(Settings.Course, Headings[i])) > Settings.CourseTolerance)
+		{
+			Stats.OffCourseSeconds += DeltaSeconds;
+		}
+
+		const bool Turning = std::fabs(Rate) >= Settings.TurnRateThreshold;
+		if (Turning)
+		{
+			if (!InRun)
+			{
+				InRun = true;
+				RunFromStart = i == Owned;
+				RunDegrees = 0.f;
+			}
+			RunDegrees += Delta;
+		}
+		else if (InRun)
+		{
+			if (RunFromStart)
+			{
+				Stats.HasPrefixRun = true;
+				Stats.PrefixDegrees = RunDegrees;
+			}
+			else
+			{
+				Stats.Turns += CountTurn(RunDegrees, Settings);
+			}
+			InRun = false;
+		}
+	}
+
+	if (InRun)
+	{
+		Stats.HasSuffixRun = true;
+		Stats.SuffixDegrees = RunDegrees;
+		if (RunFromStart)
+		{
+			Stats.AllTurning = true;
+			Stats.HasPrefixRun = true;
+			Stats.PrefixDegrees = RunDegrees;
+		}
+	}
+
+	return Stats;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "HeadingCodec.h"
+#include <array>
+
+struct AnalysisSettings
+{
+	float RateWindowSeconds = 1.f;     // Baseline of the rate-of-turn estimate
+	float TurnRateThreshold = 1.5f;    // deg/s, above this the aircraft counts as turning
+	float MinTurnDegrees = 15.f;       // Heading change a turning run needs to count as a turn
+	float MaxSampleGapSeconds = 1.f;   // Longer gaps are not counted as elapsed time
+	bool HasCourse = false;
+	float Course = 0.f;
+	float CourseTolerance = 5.f;
+};
+
+// Statistics of a contiguous span of one log. Spans of the same log merge associatively, left to
+// right in time: turning runs cut by a span edge are carried as open prefix/suffix runs until the
+// neighbouring span tells whether they continue.
+struct LogStats
+{
+	static constexpr uint HistogramBins = 36;
+
+	uint64_t Samples = 0;
+	double Seconds = 0.0;
+	uint64_t Turns = 0;
+	float MaxRateOfTurn = 0.f;
+	double OffCourseSeconds = 0.0;
+	std::array<uint64_t, HistogramBins> Histogram = {};
+
+	bool AllTurning = false;     // Every sample is in one open run (PrefixDegrees == SuffixDegrees)
+	bool HasPrefixRun = false;
+	bool HasSuffixRun = false;
+	float PrefixDegrees = 0.f;
+	float SuffixDegrees = 0.f;
+
+	// Right must directly follow Left in the same log
+	static LogStats Merge(const LogStats& Left, const LogStats& Right, const AnalysisSettings& Settings);
+	// Closes the open runs at both ends, for a span that is a whole log
+	void Finish(const AnalysisSettings& Settings);
+	// Adds the totals of an independent, finished log
+	void Accumulate(const LogStats& Other);
+};
+
+// Analyzes blocks [FirstBlock, FirstBlock + BlockCount) of a mapped log. Earlier blocks are decoded
+// as warm-up so the rate of turn at the start of the span matches a sequential pass.
+LogStats AnalyzeLogSpan(const uchar* LogData, const std::vector<HeadingBlockInfo>& Blocks, uint FirstBlock, uint BlockCount, const AnalysisSettings& Settings);
@@ -0,0 +1,228 @@
+#include "FlightLogAnalysis.h"
+#include "HeadingMath.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: HeadingLogAnalyzer [options] <log files...>\n"
+			"       HeadingLogAnalyzer --generate <count> <hours> <output prefix>\n"
+			"Options:\n"
+			"  --threads N          Worker threads (default: all hardware threads)\n"
+			"  --chunk-blocks N     Blocks per work item (default 256)\n"
+			"  --course DEG         Assigned course, enables off-course time\n"
+			"  --tolerance DEG      Off-course tolerance (default 5)\n"
+			"  --turn-rate DEG/S    Rate of turn that counts as turning (default 1.5)\n"
+			"  --min-turn DEG       Heading change that counts as a turn (default 15)\n");
+	}
+
+	// Synthetic 200 Hz logs: straight legs and rate-one turns with sensor noise
+	int GenerateLogs(int Count, double Hours, const std::string& Prefix)
+	{
+		const uint SampleCount = uint(Hours * 3600.0 * 200.0);
+
+		for (int File = 0; File < Count; File++)
+		{
+			std::mt19937 Rng(1000 + File);
+			std::normal_distribution<float> Noise(0.f, 0.05f);
+			std::uniform_real_distribution<float> Leg(20.f, 300.f);
+			std::uniform_real_distribution<float> Turn(-120.f, 120.f);
+
+			HeadingSeries Series;
+			{
+				HeadingEncoder Encoder(Series);
+				float Heading = std::uniform_real_distribution<float>(0.f, 360.f)(Rng);
+				float Remaining = 0.f;  // Degrees left in the current turn
+				float Straight = Leg(Rng);
+				for (uint i = 0; i < SampleCount; i++)
+				{
+					const float Dt = 0.005f;
+					if (Remaining != 0.f)
+					{
+						const float Step = std::min(std::fabs(Remaining), 3.f * Dt);
+						Heading += Remaining > 0.f ? Step : -Step;
+						Remaining = std::fabs(Remaining) <= Step ? 0.f : Remaining - (Remaining > 0.f ? Step : -Step);
+					}
+					else if ((Straight -= Dt) <= 0.f)
+					{
+						Remaining = Turn(Rng);
+						Straight = Leg(Rng);
+					}
+
+					Heading = HeadingMath::Wrap360(Heading);
+					Encoder.Append(int64_t(i) * 5000, HeadingMath::Wrap360(Heading + Noise(Rng)));
+				}
+			}
+
+			const std::string Path = Prefix + std::to_string(File) + ".fhlog";
+			if (!SaveHeadingLog(Path, Series))
+			{
+				return 1;
+			}
+			std::printf("Wrote %s (%llu samples, %.1f MB)\n", Path.c_str(), (unsigned long long)Series.SampleCount, Series.Bytes.size() / 1e6);
+		}
+		return 0;
+	}
+
+	void PrintReport(const LogStats& Total, const AnalysisSettings& Settings)
+	{
+		std::printf("Samples:            %llu\n", (unsigned long long)Total.Samples);
+		std::printf("Logged time:        %.2f h\n", Total.Seconds / 3600.0);
+		std::printf("Turns:              %llu\n", (unsigned long long)Total.Turns);
+		std::printf("Max rate of turn:   %.2f deg/s\n", Total.MaxRateOfTurn);
+		if (Settings.HasCourse)
+		{
+			std::printf("Off course:         %.2f h (%.1f%%, course %.1f +/- %.1f deg)\n", Total.OffCourseSeconds / 3600.0,
+				Total.Seconds > 0.0 ? 100.0 * Total.OffCourseSeconds / Total.Seconds : 0.0, Settings.Course, Settings.CourseTolerance);
+		}
+
+		uint64_t Peak = 1;
+		for (const uint64_t Bin : Total.Histogram)
+		{
+			Peak = std::max(Peak, Bin);
+		}
+
+		std::printf("Heading histogram:\n");
+		for (uint Bin = 0; Bin < LogStats::HistogramBins; Bin++)
+		{
+			const int Bar = int(40 * Total.Histogram[Bin] / Peak);
+			std::printf("  %03u-%03u %6.2f%% %.*s\n", Bin * 10, Bin * 10 + 9,
+				Total.Samples ? 100.0 * Total.Histogram[Bin] / Total.Samples : 0.0, Bar, "########################################");
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	AnalysisSettings Settings;
+	uint ThreadCount = 0;
+	uint ChunkBlocks = 256;
+	std::vector<std::string> Paths;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool HasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--generate") == 0 && i + 3 < argc)
+		{
+			return GenerateLogs(std::atoi(argv[i + 1]), std::atof(argv[i + 2]), argv[i + 3]);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && HasValue)
+		{
+			ThreadCount = uint(std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--chunk-blocks") == 0 && HasValue)
+		{
+			ChunkBlocks = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(argv[i], "--course") == 0 && HasValue)
+		{
+			Settings.HasCourse = true;
+			Settings.Course = HeadingMath::Wrap360(float(std::atof(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--tolerance") == 0 && HasValue)
+		{
+			Settings.CourseTolerance = float(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--turn-rate") == 0 && HasValue)
+		{
+			Settings.TurnRateThreshold = float(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--min-turn") == 0 && HasValue)
+		{
+			Settings.MinTurnDegrees = float(std::atof(argv[++i]));
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+		{
+			Paths.push_back(argv[i]);
+		}
+	}
+
+	if (Paths.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+
+	struct LogFile
+	{
+		MappedFile File;
+		std::vector<HeadingBlockInfo> Blocks;
+		size_t FirstChunk = 0;
+	};
+	std::vector<std::unique_ptr<LogFile>> Logs;
+	size_t ChunkCount = 0;
+	uint64_t MappedBytes = 0;
+
+	for (const std::string& Path : Paths)
+	{
+		auto Log = std::make_unique<LogFile>();
+		if (!Log->File.Open(Path) || !ReadHeadingLogIndex(Log->File.GetData(), Log->File.GetSize(), Log->Blocks))
+		{
+			std::printf("Skipping %s: not a heading log\n", Path.c_str());
+			continue;
+		}
+
+		Log->FirstChunk = ChunkCount;
+		ChunkCount += (Log->Blocks.size() + ChunkBlocks - 1) / ChunkBlocks;
+		MappedBytes += Log->File.GetSize();
+		Logs.push_back(std::move(Log));
+	}
+
+	std::vector<LogStats> ChunkStats(ChunkCount);
+	ThreadPool Pool(ThreadCount);
+
+	for (const auto& Log : Logs)
+	{
+		const uint BlockCount = uint(Log->Blocks.size());
+		for (uint First = 0, Chunk = 0; First < BlockCount; First += ChunkBlocks, Chunk++)
+		{
+			LogFile* File = Log.get();
+			LogStats* Out = &ChunkStats[File->FirstChunk + Chunk];
+			Pool.Submit([File, Out, First, BlockCount, ChunkBlocks, &Settings]()
+			{
+				*Out = AnalyzeLogSpan(File->File.GetData(), File->Blocks, First, std::min(ChunkBlocks, BlockCount - First), Settings);
+			});
+		}
+	}
+	Pool.Wait();
+
+	// Reduce: chunks of one log in time order, then logs into the total
+	LogStats Total;
+	for (size_t LogIndex = 0; LogIndex < Logs.size(); LogIndex++)
+	{
+		const size_t EndChunk = LogIndex + 1 < Logs.size() ? Logs[LogIndex + 1]->FirstChunk : ChunkCount;
+		LogStats LogTotal;
+		for (size_t Chunk = Logs[LogIndex]->FirstChunk; Chunk < EndChunk; Chunk++)
+		{
+			LogTotal = LogStats::Merge(LogTotal, ChunkStats[Chunk], Settings);
+		}
+		LogTotal.Finish(Settings);
+		Total.Accumulate(LogTotal);
+	}
+
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	std::printf("Analyzed %zu logs, %zu chunks on %u threads in %.3f s (%.1f MB/s mapped, %.1f M samples/s)\n\n",
+		Logs.size(), ChunkCount, Pool.GetThreadCount(), Seconds, MappedBytes / Seconds * 1e-6, Total.Samples / Seconds * 1e-6);
+	PrintReport(Total, Settings);
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "FillRateBenchmark.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	// Color renderbuffer target, multisampled when Samples > 1
+	struct Target
+	{
+		uint FrameBufferID = 0;
+		uint ColorBufferID = 0;
+
+		bool Create(uint Size, int Samples)
+		{
+			GLCALL(glGenRenderbuffers(1, &ColorBufferID));
+			GLCALL(glBindRenderbuffer(GL_RENDERBUFFER, ColorBufferID));
+			if (Samples > 1)
+			{
+				GLCALL(glRenderbufferStorageMultisample(GL_RENDERBUFFER, Samples, GL_RGBA8, Size, Size));
+			}
+			else
+			{
+				GLCALL(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, Size, Size));
+			}
+
+			GLCALL(glGenFramebuffers(1, &FrameBufferID));
+			GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, FrameBufferID));
+			GLCALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBufferID));
+			return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		}
+
+		void Destroy()
+		{
+			GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+			GLCALL(glDeleteFramebuffers(1, &FrameBufferID));
+			GLCALL(glDeleteRenderbuffers(1, &ColorBufferID));
+		}
+	};
+
+	// Mean GPU milliseconds per frame
+	double TimeFrames(Application& App, uint Size, uint Frames)
+	{
+		constexpr uint WarmupFrames = 16;
+		for (uint Frame = 0; Frame < WarmupFrames; Frame++)
+		{
+			App.RenderFrame(float(Frame * 7 % 360), Size, Size);
+		}
+
+		uint Query = 0;
+		GLCALL(glGenQueries(1, &Query));
+		GLuint64 TotalNs = 0;
+		for (uint Frame = 0; Frame < Frames; Frame++)
+		{
+			GLCALL(glBeginQuery(GL_TIME_ELAPSED, Query));
+			App.RenderFrame(float(Frame * 7 % 360), Size, Size);
+			GLCALL(glEndQuery(GL_TIME_ELAPSED));
+
+			// Waiting on every query keeps frames from overlapping, so each one is timed on its own
+			GLuint64 Ns = 0;
+			GLCALL(glGetQueryObjectui64v(Query, GL_QUERY_RESULT, &Ns));
+			TotalNs += Ns;
+		}
+		GLCALL(glDeleteQueries(1, &Query));
+		return TotalNs / 1e6 / std::max(Frames, 1u);
+	}
+}
+
+void RunFillRateBenchmark(Application& App, uint Size, uint Frames)
+{
+	int MaxSamples = 1;
+	GLCALL(glGetIntegerv(GL_MAX_SAMPLES, &MaxSamples));
+	const int SampleCounts[] = { 1, std::min(4, MaxSamples) };
+	const TransparencyMode Modes[] = { TransparencyMode::AlphaTest, TransparencyMode::Premultiplied, TransparencyMode::AlphaToCoverage };
+	const TransparencyMode Original = App.GetTransparency();
+
+	std::printf("Fill rate, %ux%u, %u frames per row (GPU time, clear included)\n", Size, Size, Frames);
+	std::printf("%-22s %8s %12s %14s\n", "Mode", "Samples", "ms/frame", "vs alpha test");
+	for (const int Samples : SampleCounts)
+	{
+		Target Offscreen;
+		if (!Offscreen.Create(Size, Samples))
+		{
+			std::printf("No %dx target on this GPU\n", Samples);
+			Offscreen.Destroy();
+			continue;
+		}
+
+		double AlphaTestMs = 0.0;
+		for (const TransparencyMode Mode : Modes)
+		{
+			// Coverage needs more than one sample to be anything but an alpha test at 0.5
+			if (Mode == TransparencyMode::AlphaToCoverage && Samples <= 1)
+			{
+				continue;
+			}
+
+			App.SetTransparency(Mode);
+			const double Ms = TimeFrames(App, Size, Frames);
+			if (Mode == TransparencyMode::AlphaTest)
+			{
+				AlphaTestMs = Ms;
+			}
+			std::printf("%-22s %8d %12.3f %13.2fx\n", Application::GetTransparencyName(Mode), Samples, Ms, AlphaTestMs > 0.0 ? Ms / AlphaTestMs : 0.0);
+		}
+		Offscreen.Destroy();
+	}
+	App.SetTransparency(Original);
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "Application.h"
+
+// GPU time of a gauge frame in every transparency mode, single sampled and with MSAA, measured with
+// timer queries on an offscreen target of Size x Size. Prints one row per mode and sample count.
+void RunFillRateBenchmark(Application& App, uint Size, uint Frames);
@@ -0,0 +1,160 @@
+#include "HeadlessRenderer.h"
+#include "PngWriter.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+HeadlessRenderer::HeadlessRenderer(Application& InApp, uint InSize, uint ThreadCount, uint InReadbackDepth)
+	: App(InApp), Size(InSize), Readbacks(std::max(InReadbackDepth, 1u)), Pool(ThreadCount)
+{
+	GLCALL(glGenTextures(1, &ColorTextureID));
+	GLCALL(glBindTexture(GL_TEXTURE_2D, ColorTextureID));
+	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Size, Size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+
+	GLCALL(glGenFramebuffers(1, &FrameBufferID));
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, FrameBufferID));
+	GLCALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ColorTextureID, 0));
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+		ASSERTNOENTRY("Something is not right!");
+	}
+
+	const uint FrameBytes = Size * Size * 4;
+	for (Readback& Slot : Readbacks)
+	{
+		GLCALL(glGenBuffers(1, &Slot.PixelBuffer));
+		GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, Slot.PixelBuffer));
+		GLCALL(glBufferData(GL_PIXEL_PACK_BUFFER, FrameBytes, nullptr, GL_STREAM_READ));
+	}
+	GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	// Two frames per encoder keeps every core busy while the GPU works ahead
+	for (uint i = 0; i < Pool.GetThreadCount() * 2; i++)
+	{
+		FreeStaging.emplace_back(FrameBytes);
+	}
+}
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+	Pool.Wait();
+
+	for (Readback& Slot : Readbacks)
+	{
+		if (Slot.Fence)
+		{
+			glDeleteSync(Slot.Fence);
+		}
+		GLCALL(glDeleteBuffers(1, &Slot.PixelBuffer));
+	}
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCALL(glDeleteFramebuffers(1, &FrameBufferID));
+	GLCALL(glDeleteTextures(1, &ColorTextureID));
+}
+
+uint HeadlessRenderer::RenderAll(const std::vector<float>& Headings, const std::string& OutputPrefix)
+{
+	Written = 0;
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, FrameBufferID));
+
+	for (uint Frame = 0; Frame < Headings.size(); Frame++)
+	{
+		Readback& Slot = Readbacks[Frame % Readbacks.size()];
+		if (Slot.Fence)
+		{
+			Collect(Slot, OutputPrefix);
+		}
+
+		TRACE_SCOPE("Render frame");
+		App.RenderFrame(Headings[Frame], Size, Size);
+
+		GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, Slot.PixelBuffer));
+		GLCALL(glReadPixels(0, 0, Size, Size, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		Slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		Slot.Frame = Frame;
+		Slot.Heading = Headings[Frame];
+	}
+
+	// Drain the ring oldest first
+	for (uint i = 0; i < Readbacks.size(); i++)
+	{
+		Readback& Slot = Readbacks[(Headings.size() + i) % Readbacks.size()];
+		if (Slot.Fence)
+		{
+			Collect(Slot, OutputPrefix);
+		}
+	}
+
+	GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	Pool.Wait();
+	return Written;
+}
+
+void HeadlessRenderer::Collect(Readback& Slot, const std::string& OutputPrefix)
+{
+	TRACE_SCOPE("Collect readback");
+	glClientWaitSync(Slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(Slot.Fence);
+	Slot.Fence = nullptr;
+
+	std::vector<uchar> Staging = AcquireStaging();
+
+	GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, Slot.PixelBuffer));
+	GLCALL(const void* Mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, Staging.size(), GL_MAP_READ_BIT));
+	if (!Mapped)
+	{
+		// Nothing to unmap, a failed map leaves the buffer unmapped
+		GLCALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+		ASSERTNOENTRY("Could not map the readback buffer!");
+		ReleaseStaging(std::move(Staging));
+		return;
+	}
+	std::memcpy(Staging.data(), Mapped, Staging.size());
+	GLCALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+
+	char Name[32];
+	std::snprintf(Name, sizeof(Name), "%05u_%05.1f.png", Slot.Frame, Slot.Heading);
+	const std::string Path = OutputPrefix + Name;
+
+	auto Pixels = std::make_shared<std::vector<uchar>>(std::move(Staging));
+	Pool.Submit([this, Pixels, Path]()
+	{
+		TRACE_SCOPE("Encode PNG");
+		if (PngWriter::Write(Path, Pixels->data(), Size, Size, 4, true))
+		{
+			std::lock_guard<std::mutex> Lock(StagingMutex);
+			Written++;
+		}
+		ReleaseStaging(std::move(*Pixels));
+	});
+}
+
+std::vector<uchar> HeadlessRenderer::AcquireStaging()
+{
+	std::unique_lock<std::mutex> Lock(StagingMutex);
+	if (FreeStaging.empty())
+	{
+		TRACE_SCOPE("Wait for staging buffer");
+		const auto Start = std::chrono::steady_clock::now();
+		StagingAvailable.wait(Lock, [this]() { return !FreeStaging.empty(); });
+		StallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	std::vector<uchar> Buffer = std::move(FreeStaging.back());
+	FreeStaging.pop_back();
+	return Buffer;
+}
+
+void HeadlessRenderer::ReleaseStaging(std::vector<uchar>&& Buffer)
+{
+	{
+		std::lock_guard<std::mutex> Lock(StagingMutex);
+		FreeStaging.push_back(std::move(Buffer));
+	}
+	StagingAvailable.notify_one();
+}
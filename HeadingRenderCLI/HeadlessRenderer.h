@@ -0,0 +1,50 @@
+#pragma once
+#include "Application.h"
+#include "ThreadPool.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Renders headings through Application::RenderFrame into an offscreen framebuffer and writes PNGs.
+// Readback goes through a ring of pixel pack buffers guarded by fences, so glReadPixels returns
+// immediately and a frame is only mapped once the ring comes back around to it. Mapped pixels are
+// copied into recycled staging buffers and encoded on the thread pool; when every staging buffer is
+// busy the render loop waits, so throughput settles at what the encoding cores can sustain.
+class HeadlessRenderer : public Useful::NonCopyable
+{
+public:
+	HeadlessRenderer(Application& InApp, uint InSize, uint ThreadCount = 0, uint InReadbackDepth = 3);
+	~HeadlessRenderer();
+
+	// Writes OutputPrefix<frame>_<heading>.png for every heading. Returns the number of frames written.
+	uint RenderAll(const std::vector<float>& Headings, const std::string& OutputPrefix);
+
+	inline double GetStallSeconds() const { return StallSeconds; }
+
+private:
+	struct Readback
+	{
+		uint PixelBuffer = 0;
+		GLsync Fence = nullptr;
+		uint Frame = 0;
+		float Heading = 0.f;
+	};
+
+	Application& App;
+	uint Size;
+	uint FrameBufferID = 0;
+	uint ColorTextureID = 0;
+	std::vector<Readback> Readbacks;
+	ThreadPool Pool;
+
+	std::mutex StagingMutex;
+	std::condition_variable StagingAvailable;
+	std::vector<std::vector<uchar>> FreeStaging;
+	double StallSeconds = 0.0;
+	uint Written = 0;
+
+	void Collect(Readback& Slot, const std::string& OutputPrefix);
+	std::vector<uchar> AcquireStaging();
+	void ReleaseStaging(std::vector<uchar>&& Buffer);
+};
@@ -0,0 +1,187 @@
+#include "FillRateBenchmark.h"
+#include "HeadlessRenderer.h"
+#include "HeadingCodec.h"
+#include "HeadingMath.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: HeadingRenderCLI [options] <heading source>\n"
+			"Heading sources:\n"
+			"  --range START END STEP  Headings from START to END inclusive\n"
+			"  --headings A,B,C        Explicit comma separated headings\n"
+			"  --log FILE              Every sample of a heading log (.fhlog)\n"
+			"  --fill-bench FRAMES     Instead of rendering PNGs, time FRAMES frames in every\n"
+			"                          transparency mode at --size\n"
+			"Options:\n"
+			"  --every N               With --log, render every Nth sample (default 1)\n"
+			"  --size N                Frame size in pixels (default 512)\n"
+			"  --threads N             PNG encoder threads (default: all hardware threads)\n"
+			"  --out PREFIX            Output path prefix (default frame_)\n"
+			"  --trace FILE            Write a Chrome trace of the run\n"
+			"Run from the directory containing res/.\n");
+	}
+
+	bool ReadLogHeadings(const std::string& Path, uint Every, std::vector<float>& OutHeadings)
+	{
+		MappedFile File;
+		std::vector<HeadingBlockInfo> Blocks;
+		if (!File.Open(Path) || !ReadHeadingLogIndex(File.GetData(), File.GetSize(), Blocks))
+		{
+			std::printf("%s is not a heading log\n", Path.c_str());
+			return false;
+		}
+
+		std::vector<int64_t> Times;
+		std::vector<float> Headings;
+		uint64_t Sample = 0;
+		for (const HeadingBlockInfo& Block : Blocks)
+		{
+			Times.resize(Block.Count);
+			Headings.resize(Block.Count);
+			const uint Count = HeadingDecoder::DecodeBlock(File.GetData() + Block.ByteOffset, Times.data(), Headings.data());
+			for (uint i = 0; i < Count; i++, Sample++)
+			{
+				if (Sample % Every == 0)
+				{
+					OutHeadings.push_back(Headings[i]);
+				}
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<float> Headings;
+	std::string LogPath;
+	std::string OutputPrefix = "frame_";
+	std::string TracePath;
+	uint Every = 1;
+	uint Size = 512;
+	uint ThreadCount = 0;
+	uint FillBenchFrames = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool HasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--range") == 0 && i + 3 < argc)
+		{
+			const float Start = float(std::atof(argv[i + 1]));
+			const float End = float(std::atof(argv[i + 2]));
+			const float Step = float(std::atof(argv[i + 3]));
+			i += 3;
+			if (Step == 0.f || (End - Start) / Step < 0.f)
+			{
+				std::printf("Invalid range\n");
+				return 1;
+			}
+
+			const uint Count = uint(std::floor((End - Start) / Step + 1e-4f)) + 1;
+			for (uint Index = 0; Index < Count; Index++)
+			{
+				Headings.push_back(HeadingMath::Wrap360(Start + Step * Index));
+			}
+		}
+		else if (std::strcmp(argv[i], "--headings") == 0 && HasValue)
+		{
+			std::stringstream List(argv[++i]);
+			std::string Item;
+			while (std::getline(List, Item, ','))
+			{
+				if (!Item.empty())
+				{
+					Headings.push_back(HeadingMath::Wrap360(float(std::atof(Item.c_str()))));
+				}
+			}
+		}
+		else if (std::strcmp(argv[i], "--log") == 0 && HasValue)
+		{
+			LogPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--fill-bench") == 0 && HasValue)
+		{
+			FillBenchFrames = uint(std::max(std::atoi(argv[++i]), 1));
+		}
+		else if (std::strcmp(argv[i], "--every") == 0 && HasValue)
+		{
+			Every = uint(std::max(std::atoi(argv[++i]), 1));
+		}
+		else if (std::strcmp(argv[i], "--size") == 0 && HasValue)
+		{
+			Size = uint(std::max(std::atoi(argv[++i]), 16));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && HasValue)
+		{
+			ThreadCount = uint(std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--out") == 0 && HasValue)
+		{
+			OutputPrefix = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && HasValue)
+		{
+			TracePath = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (!LogPath.empty() && !ReadLogHeadings(LogPath, Every, Headings))
+	{
+		return 1;
+	}
+
+	if (Headings.empty() && FillBenchFrames == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (!TracePath.empty())
+	{
+		Trace::Start();
+	}
+	TRACE_THREAD("Main");
+
+	Application App(true);
+	if (FillBenchFrames > 0)
+	{
+		RunFillRateBenchmark(App, Size, FillBenchFrames);
+		if (!TracePath.empty())
+		{
+			Trace::Stop(TracePath);
+		}
+		return 0;
+	}
+
+	HeadlessRenderer Renderer(App, Size, ThreadCount);
+
+	const auto Start = std::chrono::steady_clock::now();
+	const uint Written = Renderer.RenderAll(Headings, OutputPrefix);
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	std::printf("Wrote %u of %zu frames (%ux%u) in %.2f s: %.1f frames/s, render loop waited %.2f s on encoders\n",
+		Written, Headings.size(), Size, Size, Seconds, Written / Seconds, Renderer.GetStallSeconds());
+	if (!TracePath.empty())
+	{
+		Trace::Stop(TracePath);
+	}
+	return Written == Headings.size() ? 0 : 1;
+}